@@ -0,0 +1,288 @@
+/**
+* @file mirror_bench.c
+*
+* round trip of the display mirror (src/ssd1306_mirror.c) on the FreeRTOS POSIX port
+*
+* a display on the mock panel is mirrored while frames are drawn: moving shapes, shows with
+* nothing to send, ssd1306_show_paged, and a burst of noise frames shown faster than the print
+* task runs, so frames are dropped. the @OLED lines the print task writes to stdout go to LOG.
+* they are decoded here and every frame must equal the panel ram after the show that queued it.
+* with --frames the panel of each queued frame is written as DIR/frame_NNNNN.pbm, the names
+* tools/ssd1306_mirror.py gives the frames it rebuilds, so both can be compared
+*
+* the result (frames, K frames, drops, encoded bytes per frame) is printed as json
+*
+* usage: mirror_bench [--quick] [--frames DIR] [--json FILE] LOG
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stream_buffer.h"
+
+#include "ssd1306.h"
+#include "ssd1306_mock.h"
+#include "ssd1306_mirror.h"
+
+#define WIDTH 128
+#define HEIGHT 64
+#define FRAME_SIZE (WIDTH*HEIGHT/8)
+#define MAX_FRAMES 256
+
+#define MIRROR_PRIORITY 1
+#define CONTROL_PRIORITY (configMAX_PRIORITIES-1)
+
+static bool quick;
+static const char *log_path, *frames_dir, *json;
+static uint32_t errors;
+
+static ssd1306_mock_t mock;
+static ssd1306_t disp;
+static ssd1306_mirror_t mirror;
+
+// the panel ram after each show that queued a frame, in the order of the lines
+static uint8_t expected[MAX_FRAMES][FRAME_SIZE];
+static uint32_t expected_count, decoded_count;
+
+static void fail(const char *what) {
+    fprintf(stderr, "%s\n", what);
+    ++errors;
+}
+
+static void panel_frame(uint8_t *frame) {
+    for(uint32_t page=0; page<HEIGHT/8; ++page)
+        memcpy(frame+page*WIDTH, mock.gddram[page], WIDTH);
+}
+
+// notes the panel if the mirror queued a frame, frames is mirror.frames before the show
+static void note_frame(uint32_t frames) {
+    if(mirror.frames==frames)
+        return;
+    if(expected_count==MAX_FRAMES) {
+        fail("too many frames");
+        return;
+    }
+
+    panel_frame(expected[expected_count]);
+    if(frames_dir) {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/frame_%05lu.pbm", frames_dir, (unsigned long) expected_count);
+        FILE *f=fopen(path, "wb");
+        if(!f || !ssd1306_mock_write_pbm(&mock, WIDTH, HEIGHT, f))
+            fail("cannot write the expected frames");
+        if(f)
+            fclose(f);
+    }
+    ++expected_count;
+}
+
+static void show(void) {
+    const uint32_t frames=mirror.frames;
+    ssd1306_show(&disp);
+    note_frame(frames);
+}
+
+// lets the print task empty the stream buffer
+static void drain(void) {
+    while(!xStreamBufferIsEmpty(mirror.stream))
+        vTaskDelay(1);
+    vTaskDelay(2);
+}
+
+/*
+ * frames
+ */
+
+static void scene(ssd1306_t *p, void *ctx) {
+    const uint32_t i=*(const uint32_t *) ctx;
+    ssd1306_clear(p);
+    ssd1306_draw_empty_square(p, 0, 0, WIDTH, HEIGHT);
+    ssd1306_draw_circle(p, 10+(i*7)%100, 20+(i&15), 9);
+    ssd1306_draw_line(p, 0, i%HEIGHT, WIDTH-1, HEIGHT-1-i%HEIGHT);
+    ssd1306_draw_string(p, 8, 48, 1, i&1?"mirror":"@OLED D");
+}
+
+static void draw_frames(void) {
+    const uint32_t frames=quick?SSD1306_MIRROR_KEYFRAME_INTERVAL+8:3*SSD1306_MIRROR_KEYFRAME_INTERVAL;
+
+    // the blank display, then moving shapes past the K frame interval
+    ssd1306_clear(&disp);
+    show();
+    drain();
+    for(uint32_t i=0; i<frames; ++i) {
+        scene(&disp, &i);
+        show();
+        drain();
+
+        // nothing changed: no line
+        scene(&disp, &i);
+        show();
+    }
+
+    // the frames of a paged show
+    for(uint32_t i=0; i<4; ++i) {
+        const uint32_t frames=mirror.frames;
+        ssd1306_show_paged(&disp, scene, &i);
+        note_frame(frames);
+        drain();
+    }
+
+    // noise shown without waiting: the stream buffer fills up, the frames after a drop carry its changes
+    srand(20);
+    for(uint32_t i=0; i<8; ++i) {
+        for(uint32_t k=0; k<FRAME_SIZE; ++k)
+            disp.buffer[k]=rand();
+        ssd1306_invalidate(&disp);
+        show();
+    }
+    drain();
+    uint32_t last=frames;
+    scene(&disp, &last);
+    show();
+    drain();
+}
+
+/*
+ * decoding, as tools/ssd1306_mirror.py does
+ */
+
+static int hex_digit(char c) {
+    return c>='0' && c<='9'?c-'0':c>='A' && c<='F'?c-'A'+10:c>='a' && c<='f'?c-'a'+10:-1;
+}
+
+// applies the encoded difference in hex to frame, false if it is malformed
+static bool apply(uint8_t *frame, const char *hex) {
+    uint8_t data[SSD1306_MIRROR_MAX_ENCODED(FRAME_SIZE)];
+    size_t len=0;
+    for(; hex_digit(hex[0])>=0 && hex_digit(hex[1])>=0; hex+=2) {
+        if(len==sizeof(data))
+            return false;
+        data[len++]=hex_digit(hex[0])<<4|hex_digit(hex[1]);
+    }
+
+    size_t pos=0;
+    for(size_t i=0; i<len;) {
+        const uint8_t n=data[i];
+        const size_t count=n<0x80?n+1:n-0x7F;
+        if(pos+count>FRAME_SIZE || (n<0x80?i+1+count:i+2)>len)
+            return false;
+        for(size_t k=0; k<count; ++k)
+            frame[pos+k]^=data[n<0x80?i+1+k:i+1];
+        pos+=count;
+        i+=n<0x80?1+count:2;
+    }
+    return true;
+}
+
+static void decode_log(void) {
+    static char line[SSD1306_MIRROR_LINE+64];
+    static uint8_t frame[FRAME_SIZE];
+    FILE *f=fopen(log_path, "r");
+    int last_seq=-1;
+
+    if(!f) {
+        fail("cannot read the log");
+        return;
+    }
+    while(fgets(line, sizeof(line), f)) {
+        char kind;
+        unsigned seq, width, height;
+        int at=0;
+        if(sscanf(line, "@OLED %c %u %ux%u %n", &kind, &seq, &width, &height, &at)!=4 || !at
+           || (kind!='K' && kind!='D') || width!=WIDTH || height!=HEIGHT) {
+            fail("malformed line");
+            continue;
+        }
+        if(seq!=(unsigned) ((last_seq+1)&0xFF) || (kind=='D' && last_seq<0))
+            fail("frame out of sequence");
+        last_seq=seq;
+
+        if(kind=='K')
+            memset(frame, 0, sizeof(frame));
+        if(!apply(frame, line+at))
+            fail("malformed frame");
+        else if(decoded_count>=expected_count || memcmp(frame, expected[decoded_count], FRAME_SIZE))
+            fail("frame differs from the panel");
+        ++decoded_count;
+    }
+    fclose(f);
+
+    if(decoded_count!=expected_count || decoded_count!=mirror.frames)
+        fail("frames lost between the mirror and the log");
+}
+
+static void print_json(FILE *f) {
+    fprintf(f, "{\n  \"mode\": \"%s\",\n  \"frames\": %lu,\n  \"keyframes\": %lu,\n  \"dropped\": %lu,\n",
+            quick?"quick":"full", (unsigned long) mirror.frames, (unsigned long) mirror.keyframes,
+            (unsigned long) mirror.dropped);
+    fprintf(f, "  \"frame_bytes\": %u,\n  \"encoded_bytes_per_frame\": %.1f,\n  \"decoded\": %lu,\n  \"errors\": %lu\n}\n",
+            FRAME_SIZE, mirror.frames?(double) mirror.bytes/mirror.frames:0.0, (unsigned long) decoded_count,
+            (unsigned long) errors);
+}
+
+static void control_task(void *pvParameters) {
+    (void) pvParameters;
+    if(!ssd1306_mirror_start(&mirror, &disp, MIRROR_PRIORITY)) {
+        fprintf(stderr, "mirror start failed\n");
+        exit(1);
+    }
+
+    draw_frames();
+    if(!mirror.dropped)
+        fail("the burst dropped no frame");
+    if(mirror.keyframes<2)
+        fail("no K frame after the interval");
+    fflush(stdout);
+    decode_log();
+
+    FILE *out=json?fopen(json, "w"):stderr;
+    if(!out) {
+        fprintf(stderr, "cannot write %s\n", json);
+        exit(1);
+    }
+    print_json(out);
+    if(json)
+        fclose(out);
+
+    exit(errors?1:0);
+}
+
+int main(int argc, char **argv) {
+    for(int i=1; i<argc; ++i) {
+        if(!strcmp(argv[i], "--quick")) {
+            quick=true;
+        } else if(!strcmp(argv[i], "--frames") && i+1<argc) {
+            frames_dir=argv[++i];
+        } else if(!strcmp(argv[i], "--json") && i+1<argc) {
+            json=argv[++i];
+        } else if(!log_path && argv[i][0]!='-') {
+            log_path=argv[i];
+        } else {
+            log_path=NULL;
+            break;
+        }
+    }
+    if(!log_path) {
+        fprintf(stderr, "usage: %s [--quick] [--frames DIR] [--json FILE] LOG\n", argv[0]);
+        return 2;
+    }
+
+    // the mirror prints to stdout, as on the board
+    if(!freopen(log_path, "w", stdout)) {
+        fprintf(stderr, "cannot write %s\n", log_path);
+        return 1;
+    }
+
+    ssd1306_mock_init(&mock, 0);
+    if(!ssd1306_init_with_transport(&disp, WIDTH, HEIGHT, &ssd1306_mock_transport, &mock)) {
+        fprintf(stderr, "display initialization failed\n");
+        return 1;
+    }
+
+    xTaskCreate(control_task, "Control", configMINIMAL_STACK_SIZE, NULL, CONTROL_PRIORITY, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
@@ -0,0 +1,35 @@
+# runs mirror_bench, rebuilds the frames of its log with tools/ssd1306_mirror.py and compares
+# them with the panel images mirror_bench wrote
+#
+# cmake -DBENCH=mirror_bench -DPYTHON=python3 -DTOOL=tools/ssd1306_mirror.py -DOUTPUT=dir -P mirror_check.cmake
+
+file(REMOVE_RECURSE ${OUTPUT})
+file(MAKE_DIRECTORY ${OUTPUT}/expected ${OUTPUT}/tool)
+
+execute_process(COMMAND ${BENCH} --quick --frames ${OUTPUT}/expected ${OUTPUT}/mirror.log
+    RESULT_VARIABLE result)
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "mirror_bench failed: ${result}")
+endif()
+
+execute_process(COMMAND ${PYTHON} ${TOOL} ${OUTPUT}/mirror.log -o ${OUTPUT}/tool
+    RESULT_VARIABLE result)
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "ssd1306_mirror.py failed: ${result}")
+endif()
+
+file(GLOB expected RELATIVE ${OUTPUT}/expected ${OUTPUT}/expected/*.pbm)
+file(GLOB rebuilt RELATIVE ${OUTPUT}/tool ${OUTPUT}/tool/*.pbm)
+list(LENGTH expected count)
+if (count EQUAL 0 OR NOT expected STREQUAL rebuilt)
+    message(FATAL_ERROR "ssd1306_mirror.py rebuilt [${rebuilt}], mirror_bench showed [${expected}]")
+endif()
+
+foreach (frame ${expected})
+    execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OUTPUT}/expected/${frame} ${OUTPUT}/tool/${frame}
+        RESULT_VARIABLE result)
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "${frame}: ssd1306_mirror.py differs from the panel")
+    endif()
+endforeach()
+message(STATUS "${count} frames rebuilt as shown")
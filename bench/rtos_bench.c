@@ -0,0 +1,648 @@
+/**
+* @file rtos_bench.c
+*
+* host benchmarks of the task communication of main.c, on the FreeRTOS POSIX port
+*
+* display commands go from task_auth to task_display three ways: copied through the queue (the
+* old xQueueDisplay), by index into the command pool of src/keypad.c (reservar_comando_display and
+* the rest, as main.c uses them), and by index with a queue of free indices in place of the
+* in-use flags. each runs in one task (send and receive back to
+* back) and between a producer at the priority of task_auth and a consumer at the priority of
+* task_display, with the producer sending the three commands of a keypress and waiting for the
+* consumer to apply them, as the two tasks do. every command received is checked
+*
+* latency is the time from a selected digit to the next stage's matrix in task_auth, with the
+* matrix requested from task_randomizer at the keypress (the old path) or read from the session
+* generated in advance by gerar_sessao. a busy task at the flush priority stands in for the i2c
+* transfer of the previous frame, which runs above task_randomizer. the matrices come from
+* gerar_matriz
+*
+* frame time runs the loop of task_display on the keypad screen of src/keypad.c, with the mock
+* panel taking the bus time of i2c at 400 kHz: the frame sent with ssd1306_show, blocking
+* task_display for the transfer, or with ssd1306_async_show and the flush task of
+* src/ssd1306_async.c at the flush priority. task_auth sends a keypress and a cursor move in
+* turn, each frame is timed until the show call returns and until it is on the panel, and the
+* panel must show the last frame
+*
+* usage: rtos_bench [--quick] [--json FILE]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+#include "ssd1306.h"
+#include "ssd1306_async.h"
+#include "ssd1306_mock.h"
+#include "ssd1306_ui.h"
+#include "keypad.h"
+
+// priorities of main.c
+#define AUTH_PRIORITY 5
+#define DISPLAY_PRIORITY 4
+#define FLUSH_PRIORITY 3
+#define RANDOMIZER_PRIORITY 2
+#define CONTROL_PRIORITY (configMAX_PRIORITIES-1)
+
+#define COPY_QUEUE_LENGTH 10
+#define KEYPRESS_COMMANDS 3
+
+typedef enum {
+    MODE_COPY,			// the command itself through the queue
+    MODE_POOL,			// index into the pool of keypad.c, free slots marked by flags
+    MODE_FREE_QUEUE,	// index into a pool, free slots kept in a second queue
+} queue_mode_t;
+
+static const char *const mode_names[]= {"copy", "pool", "free_queue"};
+
+typedef struct {
+    const char *name;
+    double ns_per_msg;
+} result_t;
+
+typedef struct {
+    const char *name;
+    uint32_t flush_us;
+    double mean_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+} latency_t;
+
+typedef struct {
+    const char *name;
+    uint32_t ns_per_byte;
+    double busy_us;		// task_display, from the first command of the frame to the return of the show call
+    double panel_us;	// from the first command sent to the frame on the panel
+    double bytes;		// sent per frame
+} frame_time_t;
+
+static bool quick;
+static result_t results[16];
+static size_t result_count;
+static latency_t latencies[8];
+static size_t latency_count;
+static frame_time_t frame_times[2];
+static size_t frame_time_count;
+static uint32_t errors;
+
+static SemaphoreHandle_t done;
+static TaskHandle_t producer;
+
+static queue_mode_t mode;
+static uint32_t messages;
+static uint32_t sent, expected;
+static uint64_t elapsed_ns;
+static QueueHandle_t copy_queue, index_queue, free_queue;
+
+static uint64_t now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t) t.tv_sec*1000000000u+t.tv_nsec;
+}
+
+// commands of MODE_FREE_QUEUE
+static DisplayCommand_t commands[DISPLAY_COMMANDS];
+
+/*
+ * one command each way
+ */
+
+static const char matrix[NUM_LINES][NUMBERS_PER_LINE]= {
+    {'7','2','E','0'}, {'B','5','9','C'}, {'1','F','4','8'}, {'D','3','A','6'},
+};
+
+// a MATRIZ command, numbered in its first digit
+static void fill(DisplayCommand_t *cmd, uint32_t n) {
+    cmd->tipo=DISP_ATUALIZAR_MATRIZ;
+    memcpy(cmd->data.matriz, matrix, sizeof(matrix));
+    cmd->data.matriz[0][0]=(char) n;
+}
+
+static bool produce(void) {
+    switch(mode) {
+    case MODE_COPY: {
+        DisplayCommand_t cmd;
+        fill(&cmd, sent);
+        if(xQueueSend(copy_queue, &cmd, 0)!=pdPASS)
+            return false;
+        break;
+    }
+    case MODE_POOL: {
+        DisplayCommand_t *cmd=reservar_comando_display(DISP_ATUALIZAR_MATRIZ);
+        if(!cmd)
+            return false;
+        fill(cmd, sent);
+        enviar_comando_display(cmd);
+        break;
+    }
+    default: {
+        uint8_t i;
+        if(!xQueueReceive(free_queue, &i, 0))
+            return false;
+        fill(&commands[i], sent);
+        xQueueSend(index_queue, &i, 0);
+        break;
+    }
+    }
+    ++sent;
+    return true;
+}
+
+static void check(const DisplayCommand_t *cmd) {
+    if(cmd->tipo!=DISP_ATUALIZAR_MATRIZ || cmd->data.matriz[0][0]!=(char) expected
+       || memcmp(cmd->data.matriz[1], matrix[1], sizeof(matrix)-sizeof(matrix[0])))
+        ++errors;
+    ++expected;
+}
+
+static bool consume(TickType_t wait) {
+    if(mode==MODE_COPY) {
+        DisplayCommand_t cmd;
+        if(!xQueueReceive(copy_queue, &cmd, wait))
+            return false;
+        check(&cmd);
+        return true;
+    }
+
+    if(mode==MODE_POOL) {
+        DisplayCommand_t *cmd=receber_comando_display(wait);
+        if(!cmd)
+            return false;
+        check(cmd);
+        liberar_comando_display(cmd);
+        return true;
+    }
+
+    uint8_t i;
+    if(!xQueueReceive(index_queue, &i, wait))
+        return false;
+    check(&commands[i]);
+    xQueueSend(free_queue, &i, 0);
+    return true;
+}
+
+/*
+ * tasks
+ */
+
+static void one_task(void *pvParameters) {
+    (void) pvParameters;
+    const uint64_t t0=now_ns();
+    for(uint32_t n=0; n<messages; ++n) {
+        if(!produce() || !consume(0))
+            ++errors;
+    }
+    elapsed_ns=now_ns()-t0;
+
+    xSemaphoreGive(done);
+    vTaskSuspend(NULL);
+}
+
+// task_auth: the commands of a keypress, then the wait for the next key
+static void producer_task(void *pvParameters) {
+    (void) pvParameters;
+    const uint64_t t0=now_ns();
+    while(sent<messages) {
+        for(int n=0; n<KEYPRESS_COMMANDS; ++n)
+            if(!produce())
+                ++errors;
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    elapsed_ns=now_ns()-t0;
+
+    xSemaphoreGive(done);
+    vTaskSuspend(NULL);
+}
+
+// task_display: what is queued, then the frame
+static void consumer_task(void *pvParameters) {
+    (void) pvParameters;
+    while(1) {
+        if(!consume(portMAX_DELAY))
+            continue;
+        while(consume(0));
+        xTaskNotifyGive(producer);
+    }
+}
+
+static void reset(queue_mode_t m) {
+    mode=m;
+    sent=expected=0;
+    xQueueReset(copy_queue);
+    xQueueReset(index_queue);
+    xQueueReset(free_queue);
+    for(uint8_t i=0; i<DISPLAY_COMMANDS; ++i)
+        xQueueSend(free_queue, &i, 0);
+    // the keypad.c pool is empty again: every run receives and releases all it sends
+}
+
+static void add_result(const char *name, double ns) {
+    if(result_count<sizeof(results)/sizeof(results[0]))
+        results[result_count++]=(result_t) {name, ns};
+}
+
+static void bench_queue(void) {
+    static char names[6][32];
+    messages=quick?20000:1000000;
+
+    for(queue_mode_t m=MODE_COPY; m<=MODE_FREE_QUEUE; ++m) {
+        TaskHandle_t task;
+        reset(m);
+        xTaskCreate(one_task, "One", configMINIMAL_STACK_SIZE, NULL, AUTH_PRIORITY, &task);
+        xSemaphoreTake(done, portMAX_DELAY);
+        vTaskDelete(task);
+        if(expected!=messages)
+            ++errors;
+        snprintf(names[2*m], sizeof(names[0]), "%s_one_task", mode_names[m]);
+        add_result(names[2*m], (double) elapsed_ns/messages);
+
+        TaskHandle_t consumer;
+        reset(m);
+        xTaskCreate(consumer_task, "Display", configMINIMAL_STACK_SIZE, NULL, DISPLAY_PRIORITY, &consumer);
+        xTaskCreate(producer_task, "Auth", configMINIMAL_STACK_SIZE, NULL, AUTH_PRIORITY, &producer);
+        xSemaphoreTake(done, portMAX_DELAY);
+        vTaskDelete(producer);
+        vTaskDelete(consumer);
+        if(expected!=sent)
+            ++errors;
+        snprintf(names[2*m+1], sizeof(names[0]), "%s_two_tasks", mode_names[m]);
+        add_result(names[2*m+1], (double) elapsed_ns/sent);
+    }
+}
+
+/*
+ * keypress latency
+ */
+
+#define MAX_KEYPRESSES 2000
+
+typedef struct {
+    uint8_t etapa;
+    char matriz[NUM_LINES][NUMBERS_PER_LINE];
+} stage_response_t;
+
+static bool on_demand;
+static uint32_t keypresses, flush_us;
+static uint32_t latency_us[MAX_KEYPRESSES];
+static char stage_matrices[PIN_LENGTH][NUM_LINES][NUMBERS_PER_LINE];
+static QueueHandle_t request_queue, stage_queue, session_queue;
+static SemaphoreHandle_t matrix_mutex, flush_start;
+
+static uint32_t now_us(void) {
+    return now_ns()/1000;
+}
+
+// a shuffle of the 16 digits
+static bool valid_matrix(const char m[NUM_LINES][NUMBERS_PER_LINE]) {
+    uint32_t seen=0;
+    for(int i=0; i<NUM_LINES; ++i)
+        for(int j=0; j<NUMBERS_PER_LINE; ++j) {
+            const char c=m[i][j];
+            if(c>='0' && c<='9')
+                seen|=1u<<(c-'0');
+            else if(c>='A' && c<='F')
+                seen|=1u<<(c-'A'+10);
+        }
+    return seen==0xFFFF;
+}
+
+// task_randomizer: one stage on demand, as before the sessions, or a whole session
+static void randomizer_task(void *pvParameters) {
+    (void) pvParameters;
+    uint8_t request;
+    while(1) {
+        if(!xQueueReceive(request_queue, &request, portMAX_DELAY))
+            continue;
+
+        if(on_demand) {
+            stage_response_t response= {.etapa=request};
+            gerar_matriz(response.matriz);
+            xSemaphoreTake(matrix_mutex, portMAX_DELAY);
+            memcpy(stage_matrices[request], response.matriz, sizeof(response.matriz));
+            xSemaphoreGive(matrix_mutex);
+            xQueueSend(stage_queue, &response, portMAX_DELAY);
+        } else {
+            gerar_sessao(request);
+            xQueueSend(session_queue, &request, portMAX_DELAY);
+        }
+    }
+}
+
+// the flush of the previous frame, started by each keypress
+static void flush_task(void *pvParameters) {
+    (void) pvParameters;
+    while(1) {
+        xSemaphoreTake(flush_start, portMAX_DELAY);
+        const uint32_t end=now_us()+flush_us;
+        while((int32_t) (now_us()-end)<0);
+    }
+}
+
+// task_auth: the stage advances of a session, timed, then the switch to the next session
+static void auth_task(void *pvParameters) {
+    (void) pvParameters;
+    char shown[NUM_LINES][NUMBERS_PER_LINE];
+    uint8_t session=0;
+
+    if(!on_demand) {
+        uint8_t request=0;
+        xQueueSend(request_queue, &request, 0);
+        request=1;
+        xQueueSend(request_queue, &request, 0);
+        xQueueReceive(session_queue, &session, portMAX_DELAY);
+    }
+
+    for(uint32_t n=0; n<keypresses;) {
+        for(uint8_t etapa=1; etapa<PIN_LENGTH && n<keypresses; ++etapa, ++n) {
+            vTaskDelay(pdMS_TO_TICKS(2));
+            if(flush_us)
+                xSemaphoreGive(flush_start);
+
+            const uint32_t t0=now_us();
+            if(on_demand) {
+                stage_response_t response;
+                xQueueSend(request_queue, &etapa, 0);
+                xQueueReceive(stage_queue, &response, portMAX_DELAY);
+                memcpy(shown, response.matriz, sizeof(shown));
+            } else {
+                memcpy(shown, sessoes[session][etapa], sizeof(shown));
+            }
+            latency_us[n]=now_us()-t0;
+
+            if(!valid_matrix(shown))
+                ++errors;
+            if(flush_us)
+                vTaskDelay(pdMS_TO_TICKS(flush_us/1000+2));
+        }
+
+        if(!on_demand) {
+            xQueueSend(request_queue, &session, 0);
+            xQueueReceive(session_queue, &session, portMAX_DELAY);
+        }
+    }
+
+    xSemaphoreGive(done);
+    vTaskSuspend(NULL);
+}
+
+static int compare_us(const void *a, const void *b) {
+    const uint32_t x=*(const uint32_t *) a, y=*(const uint32_t *) b;
+    return x<y?-1:x>y;
+}
+
+static void bench_latency(void) {
+    // no flush, a short one, and a 384-byte MATRIZ frame at 400 kHz
+    static const uint32_t flushes[]= {0, 2000, 8600};
+    keypresses=quick?50:MAX_KEYPRESSES;
+
+    for(int demand=1; demand>=0; --demand)
+        for(size_t f=0; f<sizeof(flushes)/sizeof(flushes[0]); ++f) {
+            TaskHandle_t randomizer, flush, auth;
+            on_demand=demand;
+            flush_us=flushes[f];
+            xQueueReset(request_queue);
+            xQueueReset(stage_queue);
+            xQueueReset(session_queue);
+
+            xTaskCreate(randomizer_task, "Randomizer", configMINIMAL_STACK_SIZE, NULL, RANDOMIZER_PRIORITY, &randomizer);
+            xTaskCreate(flush_task, "Flush", configMINIMAL_STACK_SIZE, NULL, FLUSH_PRIORITY, &flush);
+            xTaskCreate(auth_task, "Auth", configMINIMAL_STACK_SIZE, NULL, AUTH_PRIORITY, &auth);
+            xSemaphoreTake(done, portMAX_DELAY);
+            vTaskDelete(auth);
+            vTaskDelete(flush);
+            vTaskDelete(randomizer);
+
+            uint64_t total=0;
+            for(uint32_t n=0; n<keypresses; ++n)
+                total+=latency_us[n];
+            qsort(latency_us, keypresses, sizeof(latency_us[0]), compare_us);
+            if(latency_count<sizeof(latencies)/sizeof(latencies[0]))
+                latencies[latency_count++]=(latency_t) {
+                    demand?"on_demand":"pre_generated", flush_us, (double) total/keypresses,
+                    latency_us[keypresses*99/100], latency_us[keypresses-1]
+                };
+        }
+}
+
+/*
+ * frame time, blocking show against the flush task
+ */
+
+#define MAX_FRAMES 400
+#define FRAME_PERIOD_MS 40
+#define BUS_NS_PER_BYTE 25000
+
+static const char other_matrix[NUM_LINES][NUMBERS_PER_LINE]= {
+    {'4','C','1','9'}, {'0','8','F','3'}, {'A','6','2','D'}, {'5','E','7','B'},
+};
+
+static ssd1306_mock_t mock;
+static ssd1306_t disp;
+static ssd1306_ui_t ui;
+static ssd1306_async_t disp_async;
+static bool use_async;
+static uint32_t frames;
+static uint64_t sent_ns, received_ns, returned_ns, shown_ns;
+
+static void frame_shown(void *ctx, const uint8_t *frame) {
+    (void) ctx;
+    (void) frame;
+    shown_ns=now_ns();
+}
+
+// task_auth: a keypress (pin, next matrix, selection back to the first row) or a cursor move
+// off the first row, so every frame changes the screen
+static void send_frame(uint32_t n) {
+    DisplayCommand_t *cmd;
+    if(n&1) {
+        if((cmd=reservar_comando_display(DISP_ATUALIZAR_SELECAO))) {
+            cmd->data.linha=1+(n>>1)%(NUM_LINES-1);
+            enviar_comando_display(cmd);
+        }
+        return;
+    }
+
+    const uint32_t digits=(n>>1)%(PIN_LENGTH+1);
+    if((cmd=reservar_comando_display(DISP_ATUALIZAR_SENHA))) {
+        memset(cmd->data.senha, '*', digits);
+        cmd->data.senha[digits]='\0';
+        enviar_comando_display(cmd);
+    }
+    if((cmd=reservar_comando_display(DISP_ATUALIZAR_MATRIZ))) {
+        memcpy(cmd->data.matriz, n&2?other_matrix:matrix, sizeof(matrix));
+        enviar_comando_display(cmd);
+    }
+    if((cmd=reservar_comando_display(DISP_ATUALIZAR_SELECAO))) {
+        cmd->data.linha=0;
+        enviar_comando_display(cmd);
+    }
+}
+
+static void frame_auth_task(void *pvParameters) {
+    (void) pvParameters;
+    uint64_t busy=0, panel=0;
+    uint32_t bytes=0;
+
+    // the whole screen first, not timed
+    send_frame(0);
+    vTaskDelay(pdMS_TO_TICKS(FRAME_PERIOD_MS));
+
+    for(uint32_t n=1; n<=frames; ++n) {
+        shown_ns=0;
+        const uint32_t sent_bytes=mock.cmd_bytes+mock.data_bytes;
+        sent_ns=now_ns();
+        send_frame(n);
+        vTaskDelay(pdMS_TO_TICKS(FRAME_PERIOD_MS));
+
+        if(!shown_ns || shown_ns<received_ns || returned_ns<received_ns || received_ns<sent_ns)
+            ++errors;
+        busy+=returned_ns-received_ns;
+        panel+=shown_ns-sent_ns;
+        bytes+=mock.cmd_bytes+mock.data_bytes-sent_bytes;
+    }
+
+    if(use_async)
+        ssd1306_async_wait(&disp_async);
+    if(!ssd1306_mock_matches(&mock, &disp))
+        ++errors;
+    if(frame_time_count<sizeof(frame_times)/sizeof(frame_times[0]))
+        frame_times[frame_time_count++]=(frame_time_t) {
+            use_async?"async_show":"show", BUS_NS_PER_BYTE, busy/1e3/frames, panel/1e3/frames, (double) bytes/frames
+        };
+
+    xSemaphoreGive(done);
+    vTaskSuspend(NULL);
+}
+
+// task_display: what is queued, then the frame
+static void frame_display_task(void *pvParameters) {
+    (void) pvParameters;
+    while(1) {
+        DisplayCommand_t *cmd=receber_comando_display(portMAX_DELAY);
+        if(!cmd)
+            continue;
+        received_ns=now_ns();
+        do {
+            aplicar_comando_display(cmd);
+            liberar_comando_display(cmd);
+        } while((cmd=receber_comando_display(0)));
+
+        if(ssd1306_ui_render(&ui)) {
+            if(use_async)
+                ssd1306_async_show(&disp_async);
+            else
+                ssd1306_show(&disp);
+        }
+        returned_ns=now_ns();
+    }
+}
+
+static void bench_frames(void) {
+    frames=quick?20:MAX_FRAMES;
+
+    // the flush task lives on, so the async run comes last
+    for(int async=0; async<=1; ++async) {
+        TaskHandle_t auth, display;
+        use_async=async;
+        ssd1306_mock_init(&mock, BUS_NS_PER_BYTE);
+        if(!ssd1306_init_with_transport(&disp, 128, 64, &ssd1306_mock_transport, &mock)
+           || (async && !ssd1306_async_start(&disp_async, &disp, FLUSH_PRIORITY))) {
+            fprintf(stderr, "display initialization failed\n");
+            ++errors;
+            return;
+        }
+        ssd1306_set_show_hook(&disp, frame_shown, NULL);
+        montar_interface(&ui, &disp);
+
+        xTaskCreate(frame_display_task, "Display", configMINIMAL_STACK_SIZE, NULL, DISPLAY_PRIORITY, &display);
+        xTaskCreate(frame_auth_task, "Auth", configMINIMAL_STACK_SIZE, NULL, AUTH_PRIORITY, &auth);
+        xSemaphoreTake(done, portMAX_DELAY);
+        vTaskDelete(auth);
+        vTaskDelete(display);
+        if(!async)
+            ssd1306_deinit(&disp);
+    }
+}
+
+static void print_json(FILE *f) {
+    fprintf(f, "{\n  \"mode\": \"%s\",\n  \"queue\": [\n", quick?"quick":"full");
+    for(size_t i=0; i<result_count; ++i) {
+        const result_t *r=&results[i];
+        fprintf(f, "    {\"name\": \"%s\", \"ns_per_msg\": %.1f, \"msgs_per_s\": %.0f}%s\n",
+                r->name, r->ns_per_msg, 1e9/r->ns_per_msg, i+1<result_count?",":"");
+    }
+    fprintf(f, "  ],\n  \"latency\": [\n");
+    for(size_t i=0; i<latency_count; ++i) {
+        const latency_t *l=&latencies[i];
+        fprintf(f, "    {\"name\": \"%s\", \"flush_us\": %lu, \"mean_us\": %.1f, \"p99_us\": %lu, \"max_us\": %lu}%s\n",
+                l->name, (unsigned long) l->flush_us, l->mean_us, (unsigned long) l->p99_us,
+                (unsigned long) l->max_us, i+1<latency_count?",":"");
+    }
+    fprintf(f, "  ],\n  \"frame_time\": [\n");
+    for(size_t i=0; i<frame_time_count; ++i) {
+        const frame_time_t *t=&frame_times[i];
+        fprintf(f, "    {\"name\": \"%s\", \"ns_per_byte\": %lu, \"busy_us\": %.1f, \"panel_us\": %.1f, \"bytes\": %.1f}%s\n",
+                t->name, (unsigned long) t->ns_per_byte, t->busy_us, t->panel_us, t->bytes,
+                i+1<frame_time_count?",":"");
+    }
+    fprintf(f, "  ],\n  \"errors\": %lu\n}\n", (unsigned long) errors);
+}
+
+static const char *json;
+
+static void control_task(void *pvParameters) {
+    (void) pvParameters;
+    bench_queue();
+    bench_latency();
+    bench_frames();
+
+    FILE *out=json?fopen(json, "w"):stdout;
+    if(!out) {
+        fprintf(stderr, "cannot write %s\n", json);
+        exit(1);
+    }
+    print_json(out);
+    if(json)
+        fclose(out);
+
+    exit(errors?1:0);
+}
+
+int main(int argc, char **argv) {
+    for(int i=1; i<argc; ++i) {
+        if(!strcmp(argv[i], "--quick")) {
+            quick=true;
+        } else if(!strcmp(argv[i], "--json") && i+1<argc) {
+            json=argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--quick] [--json FILE]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    done=xSemaphoreCreateBinary();
+    copy_queue=xQueueCreate(COPY_QUEUE_LENGTH, sizeof(DisplayCommand_t));
+    index_queue=xQueueCreate(DISPLAY_COMMANDS, sizeof(uint8_t));
+    free_queue=xQueueCreate(DISPLAY_COMMANDS, sizeof(uint8_t));
+    const bool pool=iniciar_comandos_display();
+    request_queue=xQueueCreate(PIN_LENGTH, sizeof(uint8_t));
+    stage_queue=xQueueCreate(PIN_LENGTH, sizeof(stage_response_t));
+    session_queue=xQueueCreate(2, sizeof(uint8_t));
+    matrix_mutex=xSemaphoreCreateMutex();
+    flush_start=xSemaphoreCreateBinary();
+    if(!done || !pool || !copy_queue || !index_queue || !free_queue || !request_queue || !stage_queue
+       || !session_queue || !matrix_mutex || !flush_start) {
+        fprintf(stderr, "queue creation failed\n");
+        return 1;
+    }
+
+    xTaskCreate(control_task, "Control", configMINIMAL_STACK_SIZE, NULL, CONTROL_PRIORITY, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
@@ -0,0 +1,1379 @@
+/**
+* @file ssd1306_bench.c
+*
+* host benchmarks and golden image tests of the display driver
+*
+* the driver core runs against the mock panel (src/ssd1306_mock.c). every primitive and every
+* frame task_display produces (built with the keypad screen of src/keypad.c) is timed, and
+* the result is printed as json: time per operation and the bytes and transactions a show
+* sends to the panel. the screens the panel ends up showing are compared with the golden
+* images in bench/golden, so the same run is a render regression test. the fast paths are
+* also timed against the simple implementations they replaced and must draw the same pixels.
+* the remaining checks (scrolling, bus faults injected by the mock, ...) count under "checks"
+*
+* usage: ssd1306_bench [--quick] [--golden DIR] [--update-golden DIR] [--json FILE]
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ssd1306.h"
+#include "ssd1306_fixed.h"
+#include "ssd1306_mock.h"
+#include "ssd1306_ui.h"
+#include "keypad.h"
+#include "keypad_assets.h"
+#include "font.h"
+
+#define WIDTH 128
+#define HEIGHT 64
+
+SSD1306_DEFINE_FIXED(fixed, WIDTH, HEIGHT)
+
+typedef struct {
+    const char *group;
+    const char *name;
+    double ns_per_op;
+    double bytes;			// command and data bytes sent by a show of the result, per op
+    double transactions;	// transport calls of that show, per op
+    double pixels;			// pixels drawn per op, 0 if not a rate
+} result_t;
+
+static ssd1306_mock_t mock;
+static ssd1306_t disp;
+static ssd1306_ui_t ui;
+
+static bool quick;
+static result_t results[64];
+static size_t result_count;
+static const char *golden_dir, *update_dir;
+static int golden_checked, golden_failed;
+static int reference_checked, reference_failed;
+static int checks_checked, checks_failed;
+static ssd1306_t canvas, ref_canvas;
+
+static uint64_t now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t) t.tv_sec*1000000000u+t.tv_nsec;
+}
+
+static void add_result(const char *group, const char *name, double ns, double bytes, double transactions) {
+    if(result_count<sizeof(results)/sizeof(results[0]))
+        results[result_count++]=(result_t) {group, name, ns, bytes, transactions, 0};
+}
+
+static void add_rate(const char *group, const char *name, double ns, double pixels) {
+    add_result(group, name, ns, 0, 0);
+    if(result_count)
+        results[result_count-1].pixels=pixels;
+}
+
+// runs op in batches until the time budget is used, returns ns per call
+static double time_op(void (*op)(uint32_t i)) {
+    const uint64_t budget=quick?2000000u:50000000u;
+    uint64_t elapsed=0, calls=0;
+    uint32_t batch=16;
+
+    while(elapsed<budget) {
+        const uint64_t t0=now_ns();
+        for(uint32_t i=0; i<batch; ++i)
+            op((uint32_t) (calls+i));
+        elapsed+=now_ns()-t0;
+        calls+=batch;
+        if(batch<65536)
+            batch*=2;
+    }
+    return (double) elapsed/calls;
+}
+
+static void reset_display(void) {
+    ssd1306_set_rop(&disp, SSD1306_ROP_SET);
+    ssd1306_clear(&disp);
+    ssd1306_show(&disp);
+}
+
+static void check(const char *name, bool ok) {
+    ++checks_checked;
+    if(!ok) {
+        fprintf(stderr, "%s: check failed\n", name);
+        ++checks_failed;
+    }
+}
+
+/*
+ * golden images
+ */
+
+static bool check_golden(const char *name) {
+    char *pbm=NULL;
+    size_t len=0;
+    FILE *f=open_memstream(&pbm, &len);
+    if(!f || !ssd1306_mock_write_pbm(&mock, WIDTH, HEIGHT, f)) {
+        fprintf(stderr, "%s: writing the image failed\n", name);
+        ++golden_failed;
+        return false;
+    }
+    fclose(f);
+
+    char path[512];
+    bool ok=true;
+    // continuous scrolling moves the ram away from the buffer on purpose
+    if(!mock.scrolling && !ssd1306_mock_matches(&mock, &disp)) {
+        fprintf(stderr, "%s: panel does not show the buffer\n", name);
+        ok=false;
+    }
+
+    if(update_dir) {
+        snprintf(path, sizeof(path), "%s/%s.pbm", update_dir, name);
+        FILE *out=fopen(path, "wb");
+        if(!out || fwrite(pbm, 1, len, out)!=len) {
+            fprintf(stderr, "%s: cannot write %s\n", name, path);
+            ok=false;
+        }
+        if(out)
+            fclose(out);
+    }
+
+    if(golden_dir) {
+        snprintf(path, sizeof(path), "%s/%s.pbm", golden_dir, name);
+        FILE *in=fopen(path, "rb");
+        char *ref=malloc(len+1);
+        const size_t got=in?fread(ref, 1, len+1, in):0;
+        if(!in) {
+            fprintf(stderr, "%s: missing golden image %s\n", name, path);
+            ok=false;
+        } else if(got!=len || memcmp(ref, pbm, len)) {
+            fprintf(stderr, "%s: differs from %s\n", name, path);
+            ok=false;
+        }
+        if(in)
+            fclose(in);
+        free(ref);
+    }
+
+    ++golden_checked;
+    if(!ok)
+        ++golden_failed;
+    free(pbm);
+    return ok;
+}
+
+/*
+ * primitives
+ */
+
+static uint8_t bmp[62+8*32];
+
+// 64x32 monochrome bmp, bottom up, with a diagonal stripe pattern
+static void make_bmp(void) {
+    const uint32_t w=64, h=32, stride=8;
+    memset(bmp, 0, sizeof(bmp));
+    bmp[0]='B'; bmp[1]='M';
+    bmp[2]=sizeof(bmp)&0xFF; bmp[3]=sizeof(bmp)>>8;
+    bmp[10]=62;
+    bmp[14]=40;
+    bmp[18]=w; bmp[22]=h;
+    bmp[26]=1; bmp[28]=1;
+    bmp[58]=bmp[59]=bmp[60]=0xFF;	// color 1 is white, color 0 black
+    for(uint32_t y=0; y<h; ++y)
+        for(uint32_t x=0; x<w; ++x)
+            if(((x+y)&7)<3 || x==0 || y==0 || x==w-1 || y==h-1)
+                bmp[62+(h-1-y)*stride+(x>>3)]|=0x80>>(x&7);
+}
+
+static void op_pixel(uint32_t i) { ssd1306_draw_pixel(&disp, i&127, (i>>7)&63); }
+static void op_line(uint32_t i) { ssd1306_draw_line(&disp, i&15, 3, 120-(i&15), 60); }
+static void op_hline(uint32_t i) { ssd1306_draw_line(&disp, 2, i&63, 125, i&63); }
+static void op_square(uint32_t i) { ssd1306_draw_square(&disp, 10+(i&7), 5, 60, 40); }
+static void op_clear_square(uint32_t i) { ssd1306_clear_square(&disp, i&3, 0, 15, 64); }
+static void op_empty_square(uint32_t i) { ssd1306_draw_empty_square(&disp, 10+(i&7), 5, 60, 40); }
+static void op_circle(uint32_t i) { ssd1306_draw_circle(&disp, 64+(i&7), 32, 20); }
+static void op_empty_circle(uint32_t i) { ssd1306_draw_empty_circle(&disp, 64+(i&7), 32, 20); }
+static void op_rounded(uint32_t i) { ssd1306_draw_rounded_square(&disp, 10+(i&7), 5, 80, 40, 8); }
+static void op_empty_rounded(uint32_t i) { ssd1306_draw_empty_rounded_square(&disp, 10+(i&7), 5, 80, 40, 8); }
+static void op_char(uint32_t i) { ssd1306_draw_char(&disp, 10, 10, 2, 'A'+(i&15)); }
+static void op_string(uint32_t i) { ssd1306_draw_string(&disp, i&7, 10, 1, "Senha correta!"); }
+static void op_string_keypad(uint32_t i) { ssd1306_draw_string_with_font(&disp, 25, 5+(i&3)*15, 1, font_keypad, "0 1 2 3"); }
+static void op_bmp(uint32_t i) { ssd1306_bmp_show_image_with_offset(&disp, bmp, sizeof(bmp), 30+(i&7), 16); }
+static void op_asset(uint32_t i) { ssd1306_draw_asset(&disp, 15+(i&7), 30, asset_senha_correta, sizeof(asset_senha_correta)); }
+static void op_clear(uint32_t i) { (void) i; ssd1306_clear(&disp); }
+
+static void op_show(uint32_t i) {
+    (void) i;
+    ssd1306_invalidate(&disp);
+    ssd1306_show(&disp);
+}
+
+static void bench_primitive(const char *name, void (*op)(uint32_t i)) {
+    reset_display();
+    const double ns=time_op(op);
+
+    // bytes of drawing it once on an empty screen
+    reset_display();
+    op(0);
+    ssd1306_show(&disp);
+    add_result("primitive", name, ns, disp.stats.last_show_bytes, disp.stats.last_show_transactions);
+}
+
+static void bench_primitives(void) {
+    static const struct {
+        const char *name;
+        void (*op)(uint32_t i);
+    } ops[]= {
+        {"draw_pixel", op_pixel},
+        {"draw_line", op_line},
+        {"draw_line_horizontal", op_hline},
+        {"draw_square", op_square},
+        {"clear_square", op_clear_square},
+        {"draw_empty_square", op_empty_square},
+        {"draw_circle", op_circle},
+        {"draw_empty_circle", op_empty_circle},
+        {"draw_rounded_square", op_rounded},
+        {"draw_empty_rounded_square", op_empty_rounded},
+        {"draw_char", op_char},
+        {"draw_string", op_string},
+        {"draw_string_with_font", op_string_keypad},
+        {"bmp_show_image_with_offset", op_bmp},
+        {"draw_asset", op_asset},
+        {"clear", op_clear},
+    };
+
+    for(size_t i=0; i<sizeof(ops)/sizeof(ops[0]); ++i)
+        bench_primitive(ops[i].name, ops[i].op);
+
+    reset_display();
+    const double ns=time_op(op_show);
+    add_result("primitive", "show_full_frame", ns, disp.stats.last_show_bytes, disp.stats.last_show_transactions);
+
+    // all of them on one screen
+    reset_display();
+    ssd1306_draw_empty_rounded_square(&disp, 0, 0, 128, 64, 6);
+    ssd1306_draw_line(&disp, 4, 60, 60, 4);
+    ssd1306_draw_empty_circle(&disp, 100, 20, 12);
+    ssd1306_draw_circle(&disp, 100, 20, 5);
+    ssd1306_draw_square(&disp, 70, 40, 20, 12);
+    ssd1306_draw_empty_square(&disp, 94, 40, 20, 12);
+    ssd1306_draw_string(&disp, 6, 6, 1, "ssd1306");
+    ssd1306_draw_string_with_font(&disp, 6, 50, 1, font_keypad, "0123 ABC*");
+    ssd1306_bmp_show_image_with_offset(&disp, bmp, sizeof(bmp), 8, 18);
+    ssd1306_show(&disp);
+    check_golden("primitives");
+}
+
+/*
+ * fast paths against the implementations they replaced, drawing on two canvases
+ */
+
+static void check_reference(const char *name, bool ok) {
+    ++reference_checked;
+    if(!ok) {
+        fprintf(stderr, "%s: differs from the reference implementation\n", name);
+        ++reference_failed;
+    }
+}
+
+static bool canvases_equal(void) {
+    return !memcmp(canvas.buffer, ref_canvas.buffer, WIDTH*HEIGHT/8);
+}
+
+static void mark_clean(ssd1306_t *p) {
+    memset(p->dirty_x0, 0xFF, sizeof(p->dirty_x0));
+    memset(p->dirty_x1, 0, sizeof(p->dirty_x1));
+}
+
+// rectangles as the driver drew them before the page mask fill: one pixel call per pixel
+static void ref_draw_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    for(uint32_t i=0; i<width; ++i)
+        for(uint32_t j=0; j<height; ++j)
+            ssd1306_draw_pixel(p, x+i, y+j);
+}
+
+static void ref_clear_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    for(uint32_t i=0; i<width; ++i)
+        for(uint32_t j=0; j<height; ++j)
+            ssd1306_clear_pixel(p, x+i, y+j);
+}
+
+// the selection column of the old keypad screen: cleared, then the cursor drawn again
+static void op_selection_ref(uint32_t i) {
+    ref_clear_square(&canvas, 0, 0, 15, 64);
+    ref_draw_square(&canvas, 10, 5+15*(i&3), 4, 5);
+}
+
+static void op_selection(uint32_t i) {
+    ssd1306_clear_square(&canvas, 0, 0, 15, 64);
+    ssd1306_draw_square(&canvas, 10, 5+15*(i&3), 4, 5);
+}
+
+static void op_fill_clear_ref(uint32_t i) {
+    (void) i;
+    ref_draw_square(&canvas, 0, 0, WIDTH, HEIGHT);
+    ref_clear_square(&canvas, 0, 0, WIDTH, HEIGHT);
+}
+
+static void op_fill_clear(uint32_t i) {
+    (void) i;
+    ssd1306_draw_square(&canvas, 0, 0, WIDTH, HEIGHT);
+    ssd1306_clear_square(&canvas, 0, 0, WIDTH, HEIGHT);
+}
+
+static void bench_rectangles(void) {
+    add_result("rectangle", "selection_column_per_pixel", time_op(op_selection_ref), 0, 0);
+    add_result("rectangle", "selection_column", time_op(op_selection), 0, 0);
+    add_result("rectangle", "fill_clear_screen_per_pixel", time_op(op_fill_clear_ref), 0, 0);
+    add_result("rectangle", "fill_clear_screen", time_op(op_fill_clear), 0, 0);
+
+    // random rectangles, some of them clipped, on a noisy background
+    srand(1);
+    bool same=true;
+    for(uint32_t n=0; n<(quick?2000u:200000u) && same; ++n) {
+        if(!(n&255)) {
+            for(uint32_t i=0; i<WIDTH*HEIGHT/8; ++i)
+                canvas.buffer[i]=ref_canvas.buffer[i]=rand();
+        }
+        const uint32_t x=rand()%(WIDTH+16), y=rand()%(HEIGHT+16), w=rand()%(WIDTH+1), h=rand()%(HEIGHT+1);
+        if(n&1) {
+            ssd1306_draw_square(&canvas, x, y, w, h);
+            ref_draw_square(&ref_canvas, x, y, w, h);
+        } else {
+            ssd1306_clear_square(&canvas, x, y, w, h);
+            ref_clear_square(&ref_canvas, x, y, w, h);
+        }
+        same=canvases_equal();
+    }
+    check_reference("rectangles", same);
+}
+
+// the float line the driver drew before bresenham, with the endpoint swap fixed
+static void ref_draw_line(ssd1306_t *p, int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+    if(x1>x2) {
+        int32_t t=x1; x1=x2; x2=t;
+        t=y1; y1=y2; y2=t;
+    }
+
+    if(x1==x2) {
+        if(y1>y2) {
+            const int32_t t=y1; y1=y2; y2=t;
+        }
+        for(int32_t i=y1; i<=y2; ++i)
+            ssd1306_draw_pixel(p, x1, i);
+        return;
+    }
+
+    const float m=(float) (y2-y1)/(float) (x2-x1);
+    for(int32_t i=x1; i<=x2; ++i) {
+        const float y=m*(float) (i-x1)+(float) y1;
+        ssd1306_draw_pixel(p, i, (uint32_t) y);
+    }
+}
+
+// a circle outline plotted point by point from the eight octants of the midpoint circle
+static void ref_draw_empty_circle(ssd1306_t *p, int32_t cx, int32_t cy, int32_t r) {
+    int32_t x=r, y=0, err=1-r;
+    while(x>=y) {
+        ssd1306_draw_pixel(p, cx+x, cy+y); ssd1306_draw_pixel(p, cx-x, cy+y);
+        ssd1306_draw_pixel(p, cx+x, cy-y); ssd1306_draw_pixel(p, cx-x, cy-y);
+        ssd1306_draw_pixel(p, cx+y, cy+x); ssd1306_draw_pixel(p, cx-y, cy+x);
+        ssd1306_draw_pixel(p, cx+y, cy-x); ssd1306_draw_pixel(p, cx-y, cy-x);
+
+        ++y;
+        if(err<0) {
+            err+=2*y+1;
+        } else {
+            --x;
+            err+=2*(y-x)+1;
+        }
+    }
+}
+
+static void op_hline_ref(uint32_t i) { ref_draw_line(&canvas, 2, i&63, 125, i&63); }
+static void op_hline_canvas(uint32_t i) { ssd1306_draw_line(&canvas, 2, i&63, 125, i&63); }
+static void op_diagonal_ref(uint32_t i) { ref_draw_line(&canvas, 0, i&31, 127, 32+(i&31)); }
+static void op_diagonal(uint32_t i) { ssd1306_draw_line(&canvas, 0, i&31, 127, 32+(i&31)); }
+
+static void bench_lines(void) {
+    add_rate("line", "horizontal_float", time_op(op_hline_ref), 124);
+    add_rate("line", "horizontal", time_op(op_hline_canvas), 124);
+    add_rate("line", "x_major_diagonal_float", time_op(op_diagonal_ref), 128);
+    add_rate("line", "x_major_diagonal", time_op(op_diagonal), 128);
+
+    // random circles, some of them clipped
+    srand(2);
+    bool same=true;
+    for(uint32_t n=0; n<(quick?2000u:20000u) && same; ++n) {
+        if(!(n&15)) {
+            ssd1306_clear(&canvas);
+            ssd1306_clear(&ref_canvas);
+        }
+        const int32_t x=rand()%(WIDTH+40)-20, y=rand()%(HEIGHT+40)-20, r=rand()%48;
+        ssd1306_draw_empty_circle(&canvas, x, y, r);
+        ref_draw_empty_circle(&ref_canvas, x, y, r);
+        same=canvases_equal();
+    }
+    check_reference("empty_circles", same);
+}
+
+/*
+ * bmp images: the 8x8 transpose against a decoder reading one pixel at a time
+ */
+
+static uint32_t bmp_val(const uint8_t *data, uint32_t at, uint32_t len) {
+    uint32_t v=0;
+    for(uint32_t i=0; i<len; ++i)
+        v|=(uint32_t) data[at+i]<<(8*i);
+    return v;
+}
+
+// the per pixel loop the driver used before the transpose: pixels of the black color are lit
+static void ref_bmp_show_image_with_offset(ssd1306_t *p, const uint8_t *data, uint32_t x_offset, uint32_t y_offset) {
+    const uint32_t offset=bmp_val(data, 10, 4), width=bmp_val(data, 18, 4);
+    const int32_t height=(int32_t) bmp_val(data, 22, 4);
+    const uint32_t rows=height>0?(uint32_t) height:(uint32_t) -height;
+    const uint32_t stride=((width+31)/32)*4;
+    const uint8_t *table=data+14+bmp_val(data, 14, 4);
+    const uint32_t black=!(table[0]|table[1]|table[2])?0:!(table[4]|table[5]|table[6])?1:0;
+
+    for(uint32_t y=0; y<rows; ++y)
+        for(uint32_t x=0; x<width; ++x) {
+            const uint8_t *line=data+offset+(height>0?rows-1-y:y)*stride;
+            if(((line[x>>3]>>(7-(x&7)))&1)==black)
+                ssd1306_draw_pixel(p, x_offset+x, y_offset+y);
+        }
+}
+
+// a w x h monochrome bmp of random pixels, bottom up or top down, either palette order
+static long make_random_bmp(uint8_t *data, uint32_t w, uint32_t h, bool top_down, bool black_first) {
+    const uint32_t stride=((w+31)/32)*4, size=62+stride*h;
+    memset(data, 0, 62);
+    data[0]='B'; data[1]='M';
+    data[2]=size&0xFF; data[3]=size>>8;
+    data[10]=62;
+    data[14]=40;
+    data[18]=w;
+    const uint32_t height=top_down?-h:h;
+    for(int i=0; i<4; ++i)
+        data[22+i]=height>>(8*i);
+    data[26]=1; data[28]=1;
+    memset(data+(black_first?58:54), 0xFF, 3);
+    for(uint32_t i=62; i<size; ++i)
+        data[i]=rand();
+    return size;
+}
+
+static void op_bmp_ref(uint32_t i) { ref_bmp_show_image_with_offset(&canvas, bmp, 30+(i&7), 16); }
+static void op_bmp_canvas(uint32_t i) { ssd1306_bmp_show_image_with_offset(&canvas, bmp, sizeof(bmp), 30+(i&7), 16); }
+
+static void bench_bmp(void) {
+    add_rate("bmp", "64x32_per_pixel", time_op(op_bmp_ref), 64*32);
+    add_rate("bmp", "64x32_transposed", time_op(op_bmp_canvas), 64*32);
+
+    // random images with odd widths and offsets, some clipped or outside, on a noisy background
+    // with every raster op and clip rows: buffers and dirty spans must match
+    static uint8_t data[62+16*72];
+    srand(4);
+    bool same=true;
+    for(uint32_t n=0; n<(quick?2000u:100000u) && same; ++n) {
+        for(uint32_t i=0; i<WIDTH*HEIGHT/8; ++i)
+            canvas.buffer[i]=ref_canvas.buffer[i]=rand();
+        mark_clean(&canvas);
+        mark_clean(&ref_canvas);
+        const ssd1306_rop_t rop=(ssd1306_rop_t) (n%3);
+        ssd1306_set_rop(&canvas, rop);
+        ssd1306_set_rop(&ref_canvas, rop);
+        canvas.clip_y0=ref_canvas.clip_y0=n&8?rand()%HEIGHT:0;
+        canvas.clip_y1=ref_canvas.clip_y1=canvas.clip_y0+rand()%(HEIGHT-canvas.clip_y0);
+
+        const uint32_t w=(1+rand()%(n&1?100:WIDTH/2))|(n&2?1:0), h=1+rand()%72;
+        const long size=make_random_bmp(data, w, h, n&4, rand()&1);
+        const uint32_t x=rand()%(WIDTH+8), y=rand()%(HEIGHT+8);
+        ssd1306_bmp_show_image_with_offset(&canvas, data, size, x, y);
+        ref_bmp_show_image_with_offset(&ref_canvas, data, x, y);
+        same=canvases_equal()
+             && !memcmp(canvas.dirty_x0, ref_canvas.dirty_x0, sizeof(canvas.dirty_x0))
+             && !memcmp(canvas.dirty_x1, ref_canvas.dirty_x1, sizeof(canvas.dirty_x1));
+    }
+    check_reference("bmp_images", same);
+
+    canvas.clip_y0=ref_canvas.clip_y0=0;
+    canvas.clip_y1=ref_canvas.clip_y1=HEIGHT-1;
+    ssd1306_set_rop(&canvas, SSD1306_ROP_SET);
+    ssd1306_set_rop(&ref_canvas, SSD1306_ROP_SET);
+}
+
+/*
+ * generated assets against the text they were rendered from
+ */
+
+typedef struct {
+    const char *name;
+    size_t bytes;		// size of the asset in flash
+    size_t bmp_bytes;	// size of the same picture as a monochrome bmp
+} asset_size_t;
+
+static asset_size_t asset_sizes[4];
+static size_t asset_size_count;
+
+static void add_asset_size(const char *name, size_t bytes, uint32_t width, uint32_t height) {
+    if(asset_size_count<sizeof(asset_sizes)/sizeof(asset_sizes[0]))
+        asset_sizes[asset_size_count++]=(asset_size_t) {name, bytes, 62+((width+31)/32)*4*height};
+}
+
+static void test_assets(void) {
+    static const struct {
+        const char *name;
+        const uint8_t *data;
+        size_t size;
+        const char *text;	// as in assets/keypad.assets
+    } assets[]= {
+        {"asset_senha_correta", asset_senha_correta, sizeof(asset_senha_correta), "SENHA CORRETA"},
+        {"asset_senha_incorreta", asset_senha_incorreta, sizeof(asset_senha_incorreta), "SENHA INCORRETA"},
+    };
+    static const char glyphs[]=" *0123456789ABCDEF";
+
+    // each message where task_display draws it, then at random positions, some clipped, with
+    // every raster op on a noisy background
+    srand(5);
+    bool same=true;
+    for(size_t a=0; a<sizeof(assets)/sizeof(assets[0]); ++a) {
+        add_asset_size(assets[a].name, assets[a].size, assets[a].data[1], assets[a].data[2]);
+        for(uint32_t n=0; n<(quick?200u:5000u) && same; ++n) {
+            for(uint32_t i=0; i<WIDTH*HEIGHT/8; ++i)
+                canvas.buffer[i]=ref_canvas.buffer[i]=n?rand():0;
+            const ssd1306_rop_t rop=(ssd1306_rop_t) (n%3);
+            ssd1306_set_rop(&canvas, rop);
+            ssd1306_set_rop(&ref_canvas, rop);
+            const uint32_t x=n?rand()%(WIDTH+8):15, y=n?rand()%(HEIGHT+8):30;
+            ssd1306_draw_asset(&canvas, x, y, assets[a].data, assets[a].size);
+            ssd1306_draw_string(&ref_canvas, x, y, 1, assets[a].text);
+            same=canvases_equal();
+        }
+    }
+
+    // the cut font draws its glyphs as the full one
+    ssd1306_set_rop(&canvas, SSD1306_ROP_SET);
+    ssd1306_set_rop(&ref_canvas, SSD1306_ROP_SET);
+    ssd1306_clear(&canvas);
+    ssd1306_clear(&ref_canvas);
+    ssd1306_draw_string_with_font(&canvas, 3, 20, 2, font_keypad, glyphs);
+    ssd1306_draw_string(&ref_canvas, 3, 20, 2, glyphs);
+    same=same && canvases_equal();
+    add_asset_size("font_keypad", sizeof(font_keypad), 6*(sizeof(glyphs)-1), 8);
+    check_reference("assets", same);
+
+    // the screens of the golden image: the messages where task_display draws them, and the font
+    reset_display();
+    ssd1306_draw_asset(&disp, 15, 6, asset_senha_correta, sizeof(asset_senha_correta));
+    ssd1306_draw_asset(&disp, 15, 30, asset_senha_incorreta, sizeof(asset_senha_incorreta));
+    ssd1306_draw_string_with_font(&disp, 0, 50, 1, font_keypad, glyphs);
+    ssd1306_show(&disp);
+    check_golden("assets");
+}
+
+/*
+ * strings drawn from the text cache against the glyph by glyph path
+ */
+
+static ssd1306_text_cache_t text_cache;
+
+// more strings than entries, so the random draws keep evicting
+static const char *const cache_strings[]= {
+    "0 1 2 3", "4 5 6 7", "8 9 A B", "C D E F", "******", "SENHA", "row", "ssd1306",
+    "7 2 E 0", "B 5 9 C", "1 F 4 8", "D 3 A 6",
+};
+
+static void draw_keypad_rows(ssd1306_t *p, uint32_t i) {
+    for(uint32_t row=0; row<NUM_LINES; ++row)
+        ssd1306_draw_string_with_font(p, 25, 5+row*15, 1, font_keypad, cache_strings[(i+row)&3]);
+}
+
+static void op_text_uncached(uint32_t i) { draw_keypad_rows(&ref_canvas, i); }
+static void op_text_cached(uint32_t i) { draw_keypad_rows(&canvas, i); }
+
+static void test_text_cache(void) {
+    ssd1306_set_text_cache(&canvas, &text_cache);
+    ssd1306_set_rop(&canvas, SSD1306_ROP_XOR);
+    ssd1306_set_rop(&ref_canvas, SSD1306_ROP_XOR);
+    add_result("text", "keypad_rows_uncached", time_op(op_text_uncached), 0, 0);
+    add_result("text", "keypad_rows_cached", time_op(op_text_cached), 0, 0);
+
+    // hits, misses and least recently used eviction
+    ssd1306_set_text_cache(&canvas, &text_cache);
+    for(int pass=0; pass<2; ++pass)
+        for(size_t i=0; i<SSD1306_TEXT_CACHE_ENTRIES; ++i)
+            ssd1306_draw_string(&canvas, 0, 0, 1, cache_strings[i]);
+    const bool filled=text_cache.misses==SSD1306_TEXT_CACHE_ENTRIES && text_cache.hits==SSD1306_TEXT_CACHE_ENTRIES;
+    ssd1306_draw_string(&canvas, 0, 0, 1, cache_strings[8]);		// evicts cache_strings[0]
+    ssd1306_draw_string(&canvas, 0, 0, 1, cache_strings[0]);		// evicts cache_strings[1]
+    ssd1306_draw_string(&canvas, 0, 0, 1, cache_strings[2]);		// still cached
+    ssd1306_draw_string(&canvas, 0, 0, 2, cache_strings[2]);		// another scale is another entry
+    ssd1306_draw_string(&canvas, 0, 0, 1, cache_strings[1]);
+    check("text_cache_counts", filled && text_cache.misses==SSD1306_TEXT_CACHE_ENTRIES+4
+          && text_cache.hits==SSD1306_TEXT_CACHE_ENTRIES+1);
+
+    // random strings, fonts, scales, positions and raster ops on a noisy background
+    srand(6);
+    bool same=true;
+    for(uint32_t n=0; n<(quick?2000u:100000u) && same; ++n) {
+        if(!(n&63)) {
+            for(uint32_t i=0; i<WIDTH*HEIGHT/8; ++i)
+                canvas.buffer[i]=ref_canvas.buffer[i]=rand();
+            mark_clean(&canvas);
+            mark_clean(&ref_canvas);
+        }
+        const ssd1306_rop_t rop=(ssd1306_rop_t) (rand()%3);
+        ssd1306_set_rop(&canvas, rop);
+        ssd1306_set_rop(&ref_canvas, rop);
+        const char *text=cache_strings[rand()%(sizeof(cache_strings)/sizeof(cache_strings[0]))];
+        const uint8_t *font=rand()&1?font_keypad:font_8x5;
+        const uint32_t x=rand()%(WIDTH+8), y=rand()%(HEIGHT+8), scale=1+rand()%2;
+        ssd1306_draw_string_with_font(&canvas, x, y, scale, font, text);
+        ssd1306_draw_string_with_font(&ref_canvas, x, y, scale, font, text);
+        same=canvases_equal()
+             && !memcmp(canvas.dirty_x0, ref_canvas.dirty_x0, sizeof(canvas.dirty_x0))
+             && !memcmp(canvas.dirty_x1, ref_canvas.dirty_x1, sizeof(canvas.dirty_x1));
+    }
+    check_reference("text_cache", same && text_cache.hits>0);
+    ssd1306_set_text_cache(&canvas, NULL);
+    ssd1306_set_rop(&canvas, SSD1306_ROP_SET);
+    ssd1306_set_rop(&ref_canvas, SSD1306_ROP_SET);
+
+    // the keypad screen drawn twice from the cache: the second time only hits
+    reset_display();
+    ssd1306_set_text_cache(&disp, &text_cache);
+    draw_keypad_rows(&disp, 0);
+    ssd1306_clear(&disp);
+    draw_keypad_rows(&disp, 0);
+    ssd1306_draw_string(&disp, 90, 0, 1, "cached");
+    ssd1306_show(&disp);
+    ssd1306_set_text_cache(&disp, NULL);
+    ssd1306_clear(&ref_canvas);
+    draw_keypad_rows(&ref_canvas, 0);
+    ssd1306_draw_string(&ref_canvas, 90, 0, 1, "cached");
+    check("text_cache_screen", text_cache.misses==NUM_LINES+1 && text_cache.hits==NUM_LINES
+          && !memcmp(disp.buffer, ref_canvas.buffer, WIDTH*HEIGHT/8));
+    check_golden("text_cache");
+}
+
+/*
+ * raster ops: a shape drawn twice in xor is gone, and only the bytes it changed are dirty
+ */
+
+static ssd1306_t sprite;
+
+static void xor_pixel(ssd1306_t *p) { ssd1306_draw_pixel(p, 77, 13); }
+static void xor_line(ssd1306_t *p) { ssd1306_draw_line(p, -10, 70, 140, 3); }
+static void xor_square(ssd1306_t *p) { ssd1306_draw_square(p, 9, 5, 33, 41); }
+static void xor_square_clipped(ssd1306_t *p) { ssd1306_draw_square(p, 100, 50, 60, 30); }
+static void xor_empty_square(ssd1306_t *p) { ssd1306_draw_empty_square(p, 3, 19, 90, 22); }
+static void xor_circle(ssd1306_t *p) { ssd1306_draw_circle(p, 120, 4, 17); }
+static void xor_empty_circle(ssd1306_t *p) { ssd1306_draw_empty_circle(p, 64, 32, 29); }
+static void xor_rounded(ssd1306_t *p) { ssd1306_draw_rounded_square(p, -5, 37, 70, 30, 9); }
+static void xor_empty_rounded(ssd1306_t *p) { ssd1306_draw_empty_rounded_square(p, 21, 3, 85, 58, 12); }
+static void xor_string(ssd1306_t *p) { ssd1306_draw_string(p, 5, 27, 2, "XOR 42"); }
+static void xor_string_keypad(ssd1306_t *p) { ssd1306_draw_string_with_font(p, 25, 35, 1, font_keypad, "0 1 2 3"); }
+static void xor_bmp(ssd1306_t *p) { ssd1306_bmp_show_image_with_offset(p, bmp, sizeof(bmp), 83, 37); }
+static void xor_asset(ssd1306_t *p) { ssd1306_draw_asset(p, 11, 29, asset_senha_correta, sizeof(asset_senha_correta)); }
+static void xor_blit(ssd1306_t *p) { ssd1306_blit(p, 50, -3, &sprite, NULL); }
+
+static const struct {
+    const char *name;
+    void (*draw)(ssd1306_t *p);
+    bool cached;	// drawn through the text cache: rendered the first time, copied the second
+} xor_draws[]= {
+    {"xor_pixel", xor_pixel, false},
+    {"xor_line", xor_line, false},
+    {"xor_square", xor_square, false},
+    {"xor_square_clipped", xor_square_clipped, false},
+    {"xor_empty_square", xor_empty_square, false},
+    {"xor_circle", xor_circle, false},
+    {"xor_empty_circle", xor_empty_circle, false},
+    {"xor_rounded", xor_rounded, false},
+    {"xor_empty_rounded", xor_empty_rounded, false},
+    {"xor_string", xor_string, false},
+    {"xor_string_keypad", xor_string_keypad, false},
+    {"xor_string_cached", xor_string, true},
+    {"xor_bmp", xor_bmp, false},
+    {"xor_asset", xor_asset, false},
+    {"xor_blit", xor_blit, false},
+};
+
+// the dirty span of every page covers exactly the columns that differ from before
+static bool spans_exact(const ssd1306_t *p, const uint8_t *before) {
+    for(uint32_t page=0; page<p->pages; ++page) {
+        uint32_t x0=0xFF, x1=0;
+        for(uint32_t x=0; x<p->width; ++x)
+            if(p->buffer[page*p->width+x]!=before[page*p->width+x]) {
+                if(x<x0)
+                    x0=x;
+                x1=x;
+            }
+        if(x0>x1?p->dirty_x0[page]<=p->dirty_x1[page]:p->dirty_x0[page]!=x0 || p->dirty_x1[page]!=x1)
+            return false;
+    }
+    return true;
+}
+
+static void test_xor(void) {
+    static uint8_t background[WIDTH*HEIGHT/8], drawn[WIDTH*HEIGHT/8];
+
+    if(!ssd1306_canvas_init(&sprite, 20, 13, NULL)) {
+        check("xor_init", false);
+        return;
+    }
+    srand(6);
+    for(uint32_t i=0; i<20*2; ++i)
+        sprite.buffer[i]=rand();
+
+    // on a noisy background, drawing changes some bytes and drawing again changes them back
+    for(size_t i=0; i<sizeof(xor_draws)/sizeof(xor_draws[0]); ++i) {
+        for(uint32_t k=0; k<sizeof(background); ++k)
+            background[k]=canvas.buffer[k]=rand();
+        ssd1306_set_rop(&canvas, SSD1306_ROP_XOR);
+        ssd1306_set_text_cache(&canvas, xor_draws[i].cached?&text_cache:NULL);
+        mark_clean(&canvas);
+        xor_draws[i].draw(&canvas);
+        const bool changed=memcmp(canvas.buffer, background, sizeof(background))!=0;
+        const bool first=spans_exact(&canvas, background);
+
+        memcpy(drawn, canvas.buffer, sizeof(drawn));
+        mark_clean(&canvas);
+        xor_draws[i].draw(&canvas);
+        check(xor_draws[i].name, changed && first && spans_exact(&canvas, drawn)
+              && !memcmp(canvas.buffer, background, sizeof(background))
+              && (!xor_draws[i].cached || (text_cache.misses==1 && text_cache.hits==1)));
+    }
+    ssd1306_set_text_cache(&canvas, NULL);
+    ssd1306_set_rop(&canvas, SSD1306_ROP_SET);
+    ssd1306_deinit(&sprite);
+}
+
+/*
+ * pixel functions of ssd1306_fixed.h against the runtime geometry ones
+ */
+
+static void op_xor_generic(uint32_t i) {
+    (void) i;
+    for(uint32_t y=0; y<HEIGHT; ++y)
+        for(uint32_t x=0; x<WIDTH; ++x)
+            ssd1306_draw_pixel(&canvas, x, y);
+}
+
+static void op_xor_fixed(uint32_t i) {
+    (void) i;
+    for(uint32_t y=0; y<HEIGHT; ++y)
+        for(uint32_t x=0; x<WIDTH; ++x)
+            fixed_draw_pixel(&canvas, x, y);
+}
+
+static void op_xor_fixed_unchecked(uint32_t i) {
+    (void) i;
+    for(uint32_t y=0; y<HEIGHT; ++y)
+        for(uint32_t x=0; x<WIDTH; ++x)
+            fixed_draw_pixel_unchecked(&canvas, x, y);
+}
+
+static bool ref_get_pixel(const ssd1306_t *p, uint32_t x, uint32_t y) {
+    return x<p->width && y<p->height && (p->buffer[x+p->width*(y>>3)]>>(y&7))&1;
+}
+
+static void bench_fixed(void) {
+    ssd1306_set_rop(&canvas, SSD1306_ROP_XOR);
+    add_rate("fixed", "xor_frame_generic", time_op(op_xor_generic), WIDTH*HEIGHT);
+    add_rate("fixed", "xor_frame_fixed", time_op(op_xor_fixed), WIDTH*HEIGHT);
+    add_rate("fixed", "xor_frame_fixed_unchecked", time_op(op_xor_fixed_unchecked), WIDTH*HEIGHT);
+
+    // random pixel ops, some outside the display, with every raster op and the clip rows the
+    // paged show sets: buffers, dirty spans and reads must match
+    srand(3);
+    ssd1306_clear(&canvas);
+    ssd1306_clear(&ref_canvas);
+    bool same=true;
+    for(uint32_t n=0; n<(quick?20000u:1000000u) && same; ++n) {
+        if(!(n&4095)) {
+            mark_clean(&canvas);
+            mark_clean(&ref_canvas);
+            const ssd1306_rop_t rop=(ssd1306_rop_t) ((n>>12)%3);
+            ssd1306_set_rop(&canvas, rop);
+            ssd1306_set_rop(&ref_canvas, rop);
+            const uint8_t page=(n>>12)&7;
+            canvas.clip_y0=ref_canvas.clip_y0=(n>>15)&1?page*8:0;
+            canvas.clip_y1=ref_canvas.clip_y1=(n>>15)&1?page*8+7:HEIGHT-1;
+        }
+        const uint32_t x=rand()%(WIDTH+8), y=rand()%(HEIGHT+8);
+        const bool inside=x<WIDTH && y>=canvas.clip_y0 && y<=canvas.clip_y1;
+        switch(rand()&3) {
+        case 0:
+            fixed_draw_pixel(&canvas, x, y);
+            ssd1306_draw_pixel(&ref_canvas, x, y);
+            break;
+        case 1:
+            fixed_clear_pixel(&canvas, x, y);
+            ssd1306_clear_pixel(&ref_canvas, x, y);
+            break;
+        case 2:
+            if(inside) {
+                fixed_draw_pixel_unchecked(&canvas, x, y);
+                ssd1306_draw_pixel(&ref_canvas, x, y);
+            }
+            break;
+        default:
+            if(inside) {
+                fixed_clear_pixel_unchecked(&canvas, x, y);
+                ssd1306_clear_pixel(&ref_canvas, x, y);
+            }
+            break;
+        }
+        same=canvases_equal()
+             && !memcmp(canvas.dirty_x0, ref_canvas.dirty_x0, sizeof(canvas.dirty_x0))
+             && !memcmp(canvas.dirty_x1, ref_canvas.dirty_x1, sizeof(canvas.dirty_x1))
+             && fixed_get_pixel(&canvas, x, y)==ref_get_pixel(&ref_canvas, x, y);
+    }
+    check_reference("fixed_pixels", same);
+
+    canvas.clip_y0=ref_canvas.clip_y0=0;
+    canvas.clip_y1=ref_canvas.clip_y1=HEIGHT-1;
+    ssd1306_set_rop(&canvas, SSD1306_ROP_SET);
+    ssd1306_set_rop(&ref_canvas, SSD1306_ROP_SET);
+}
+
+/*
+ * masked blits against a per-pixel copy
+ */
+
+static ssd1306_t blit_src, blit_mask;
+
+static void ref_put_pixel(ssd1306_t *p, uint32_t x, uint32_t y, bool on) {
+    uint8_t *b=&p->buffer[x+p->width*(y>>3)];
+    *b=on?*b|1<<(y&7):*b&~(1<<(y&7));
+}
+
+// ssd1306_blit one pixel at a time: the pixels of src under the mask that land inside the
+// clip rows are copied (SET), or cleared or inverted where src is lit (CLEAR, XOR)
+static void ref_blit(ssd1306_t *p, int32_t x, int32_t y, const ssd1306_t *src, const ssd1306_t *mask) {
+    for(uint32_t sy=0; sy<src->height; ++sy)
+        for(uint32_t sx=0; sx<src->width; ++sx) {
+            const int32_t dx=x+sx, dy=y+sy;
+            if(dx<0 || dx>=p->width || dy<p->clip_y0 || dy>p->clip_y1 || (mask && !ref_get_pixel(mask, sx, sy)))
+                continue;
+            const bool on=ref_get_pixel(src, sx, sy), old=ref_get_pixel(p, dx, dy);
+            if(p->rop==SSD1306_ROP_SET)
+                ref_put_pixel(p, dx, dy, on);
+            else if(on)
+                ref_put_pixel(p, dx, dy, p->rop==SSD1306_ROP_XOR && !old);
+        }
+}
+
+static void op_blit_ref(uint32_t i) { ref_blit(&canvas, 3+(i&7), 5+(i&7), &blit_src, &blit_mask); }
+static void op_blit(uint32_t i) { ssd1306_blit(&canvas, 3+(i&7), 5+(i&7), &blit_src, &blit_mask); }
+
+static void test_blit(void) {
+    static uint8_t before[WIDTH*HEIGHT/8];
+    const uint32_t rounds=quick?2000:30000;
+    bool same=true, spans=true;
+
+    // sources of any size, their unused rows and the bytes past them full of noise
+    srand(7);
+    for(uint32_t i=0; i<rounds; ++i) {
+        const uint32_t w=1+rand()%48, h=1+rand()%HEIGHT;
+        if(!ssd1306_canvas_init(&blit_src, w, h, NULL) || !ssd1306_canvas_init(&blit_mask, w, h, NULL)) {
+            check("blit_init", false);
+            return;
+        }
+        for(uint32_t k=0; k<SSD1306_CANVAS_SIZE(w, h)-1; ++k) {
+            blit_src.buffer[k]=rand();
+            blit_mask.buffer[k]=rand();
+        }
+        for(uint32_t k=0; k<sizeof(before); ++k)
+            canvas.buffer[k]=ref_canvas.buffer[k]=rand();
+        memcpy(before, canvas.buffer, sizeof(before));
+
+        // offsets off every edge and off the byte grid, clip rows as ssd1306_show_paged sets them
+        const int32_t x=rand()%(WIDTH+2*w)-(int32_t) w-4, y=rand()%(HEIGHT+2*h)-(int32_t) h-4;
+        const ssd1306_rop_t rop=rand()%3;
+        const ssd1306_t *mask=rand()&1?&blit_mask:NULL;
+        canvas.clip_y0=ref_canvas.clip_y0=rand()&3?0:rand()%HEIGHT;
+        canvas.clip_y1=ref_canvas.clip_y1=rand()&3?HEIGHT-1:canvas.clip_y0+rand()%(HEIGHT-canvas.clip_y0);
+        ssd1306_set_rop(&canvas, rop);
+        ssd1306_set_rop(&ref_canvas, rop);
+        mark_clean(&canvas);
+
+        ssd1306_blit(&canvas, x, y, &blit_src, mask);
+        ref_blit(&ref_canvas, x, y, &blit_src, mask);
+        same=same && canvases_equal();
+        spans=spans && spans_exact(&canvas, before);
+
+        ssd1306_deinit(&blit_src);
+        ssd1306_deinit(&blit_mask);
+    }
+    check_reference("blits", same);
+    check("blit_dirty_spans", spans);
+
+    canvas.clip_y0=ref_canvas.clip_y0=0;
+    canvas.clip_y1=ref_canvas.clip_y1=HEIGHT-1;
+    ssd1306_set_rop(&canvas, SSD1306_ROP_SET);
+    ssd1306_set_rop(&ref_canvas, SSD1306_ROP_SET);
+
+    // a 40x24 sprite through its mask, at an offset off the byte grid
+    if(!ssd1306_canvas_init(&blit_src, 40, 24, NULL) || !ssd1306_canvas_init(&blit_mask, 40, 24, NULL)) {
+        check("blit_init", false);
+        return;
+    }
+    ssd1306_draw_string(&blit_src, 0, 8, 1, "sprite");
+    ssd1306_draw_rounded_square(&blit_mask, 0, 0, 40, 24, 6);
+    add_rate("blit", "masked_40x24_per_pixel", time_op(op_blit_ref), 40*24);
+    add_rate("blit", "masked_40x24", time_op(op_blit), 40*24);
+    ssd1306_deinit(&blit_src);
+    ssd1306_deinit(&blit_mask);
+}
+
+/*
+ * frames of task_display
+ */
+
+static const char matrices[2][NUM_LINES][NUMBERS_PER_LINE]= {
+    {{'7','2','E','0'}, {'B','5','9','C'}, {'1','F','4','8'}, {'D','3','A','6'}},
+    {{'4','C','1','9'}, {'0','8','F','3'}, {'A','6','2','D'}, {'5','E','7','B'}},
+};
+
+static void send(DisplayCommandType_t type, uint32_t value) {
+    DisplayCommand_t cmd= {.tipo=type};
+    switch(type) {
+    case DISP_ATUALIZAR_MATRIZ:
+        memcpy(cmd.data.matriz, matrices[value&1], sizeof(cmd.data.matriz));
+        break;
+    case DISP_ATUALIZAR_SELECAO:
+        cmd.data.linha=value%NUM_LINES;
+        break;
+    case DISP_ATUALIZAR_SENHA:
+        memset(cmd.data.senha, '*', value%(PIN_LENGTH+1));
+        cmd.data.senha[value%(PIN_LENGTH+1)]='\0';
+        break;
+    case DISP_MENSAGEM:
+        cmd.data.mensagem=value&1?MENSAGEM_SENHA_INCORRETA:MENSAGEM_SENHA_CORRETA;
+        break;
+    default:
+        break;
+    }
+    aplicar_comando_display(&cmd);
+}
+
+// what task_display does with the commands of one frame
+static void render(void) {
+    if(ssd1306_ui_render(&ui))
+        ssd1306_show(&disp);
+}
+
+static void keypad_start(void) {
+    send(DISP_ATUALIZAR_MATRIZ, 0);
+    send(DISP_ATUALIZAR_SELECAO, 0);
+    send(DISP_ATUALIZAR_SENHA, 0);
+    render();
+}
+
+static void frame_matrix(uint32_t i) { send(DISP_ATUALIZAR_MATRIZ, i+1); }
+static void frame_selection(uint32_t i) { send(DISP_ATUALIZAR_SELECAO, i+1); }
+static void frame_pin(uint32_t i) { send(DISP_ATUALIZAR_SENHA, i+1); }
+static void frame_message(uint32_t i) { send(DISP_MENSAGEM, i); }
+
+// a selected digit: task_auth sends the pin field, the next stage's matrix and the selection
+static void frame_keypress(uint32_t i) {
+    send(DISP_ATUALIZAR_SENHA, i%PIN_LENGTH+1);
+    send(DISP_ATUALIZAR_MATRIZ, i+1);
+    send(DISP_ATUALIZAR_SELECAO, i);
+}
+
+// times apply + render + show of a frame, restore (if any) puts the screen back untimed
+static void bench_frame(const char *name, void (*apply)(uint32_t i), void (*restore)(uint32_t i)) {
+    const uint32_t frames=quick?200:20000;
+    uint64_t ns=0, bytes=0, transactions=0;
+
+    keypad_start();
+    for(uint32_t i=0; i<frames; ++i) {
+        const uint32_t shows=disp.stats.shows;
+        const uint64_t t0=now_ns();
+        apply(i);
+        render();
+        ns+=now_ns()-t0;
+        if(disp.stats.shows!=shows) {
+            bytes+=disp.stats.last_show_bytes;
+            transactions+=disp.stats.last_show_transactions;
+        }
+        if(restore) {
+            restore(i);
+            render();
+        }
+    }
+    add_result("frame", name, (double) ns/frames, (double) bytes/frames, (double) transactions/frames);
+}
+
+static void back_to_matrix(uint32_t i) { send(DISP_ATUALIZAR_MATRIZ, i); }
+
+static void bench_frames(void) {
+    ssd1306_clear(&disp);
+    ssd1306_show(&disp);
+    montar_interface(&ui, &disp);
+
+    bench_frame("keypad_matrix", frame_matrix, NULL);
+    bench_frame("keypad_selection", frame_selection, NULL);
+    bench_frame("keypad_pin", frame_pin, NULL);
+    bench_frame("keypad_keypress", frame_keypress, NULL);
+    bench_frame("keypad_message", frame_message, back_to_matrix);
+
+    // screens for the golden images
+    keypad_start();
+    check_golden("keypad_matrix");
+    send(DISP_ATUALIZAR_SELECAO, 2);
+    render();
+    check_golden("keypad_selection");
+    send(DISP_ATUALIZAR_SENHA, 3);
+    render();
+    check_golden("keypad_pin");
+    frame_keypress(3);
+    render();
+    check_golden("keypad_keypress");
+    send(DISP_MENSAGEM, 0);
+    render();
+    check_golden("keypad_correct");
+    send(DISP_MENSAGEM, 1);
+    render();
+    check_golden("keypad_incorrect");
+}
+
+/*
+ * scrolling: whole pages through the buffer and the start line, continuous on the panel
+ */
+
+// one labelled row per page, page 0 showing the text of row first
+static void draw_rows(ssd1306_t *p, uint32_t first, uint32_t from_page, uint32_t to_page) {
+    for(uint32_t page=from_page; page<=to_page; ++page) {
+        char text[16];
+        snprintf(text, sizeof(text), "row %u", (unsigned) (first+page));
+        ssd1306_draw_string(p, 4+(first+page)*6, page*8, 1, text);
+        ssd1306_draw_pixel(p, 0, page*8+((first+page)&7));
+    }
+}
+
+// whether ram page ram_page of the panel is buffer page page moved by shift columns
+static bool ram_rotated(const ssd1306_mock_t *m, uint32_t ram_page, const uint8_t *page, int32_t shift) {
+    for(uint32_t x=0; x<WIDTH; ++x)
+        if(m->gddram[ram_page][(x+WIDTH+shift)%WIDTH]!=page[x])
+            return false;
+    return true;
+}
+
+static void test_scroll(void) {
+    reset_display();
+    ssd1306_set_start_line(&disp, 0);
+    draw_rows(&disp, 0, 0, 7);
+    ssd1306_show(&disp);
+
+    // two pages up: only the two pages scrolled in are sent, drawn with the next rows
+    ssd1306_scroll_pages(&disp, 2);
+    draw_rows(&disp, 2, 6, 7);
+    ssd1306_show(&disp);
+    ssd1306_clear(&ref_canvas);
+    draw_rows(&ref_canvas, 2, 0, 7);
+    check("scroll_pages_sent", disp.start_line==16 && disp.stats.last_show_bytes<=2*WIDTH+16);
+    check("scroll_pages_buffer", !memcmp(disp.buffer, ref_canvas.buffer, WIDTH*HEIGHT/8));
+    check_golden("scroll_pages");
+
+    // one page back down, the start line wrapping past ram page 0
+    ssd1306_scroll_pages(&disp, -3);
+    draw_rows(&disp, 63, 0, 0);
+    ssd1306_show(&disp);
+    check("scroll_pages_down", disp.start_line==56 && ssd1306_mock_matches(&mock, &disp));
+
+    // three rows more: the picture moves without a show, the image follows the start line
+    const uint32_t bytes=mock.data_bytes;
+    ssd1306_set_start_line(&disp, disp.start_line+3);
+    check("scroll_start_line", mock.data_bytes==bytes && mock.start_line==59);
+    check_golden("scroll_start_line");
+
+    // continuous scrolling of ram pages 0..3 to the left, from the start line 0
+    ssd1306_set_start_line(&disp, 0);
+    ssd1306_invalidate(&disp);
+    ssd1306_show(&disp);
+    ssd1306_scroll_horizontal(&disp, true, 0, 3, 7);
+    for(int i=0; i<16; ++i)
+        ssd1306_mock_scroll_step(&mock);
+    bool moved=mock.scrolling;
+    for(uint32_t page=0; page<disp.pages; ++page)
+        moved=moved && ram_rotated(&mock, page, disp.buffer+page*WIDTH, page<=3?-16:0);
+    check("scroll_horizontal", moved);
+    check_golden("scroll_horizontal");
+
+    // stopping leaves the ram moved, the next show sends the frame again
+    ssd1306_scroll_stop(&disp);
+    ssd1306_show(&disp);
+    check("scroll_stop", !mock.scrolling && mock.writes_while_scrolling==0 && ssd1306_mock_matches(&mock, &disp));
+
+    // diagonal: all pages to the right, rows 16..63 up by one row per step
+    ssd1306_scroll_area(&disp, 16, 48);
+    ssd1306_scroll_diagonal(&disp, false, 0, 7, 0, 1);
+    for(int i=0; i<8; ++i)
+        ssd1306_mock_scroll_step(&mock);
+    moved=mock.scrolling && mock.scroll_top==16 && mock.scroll_rows==48 && mock.scroll_offset==8;
+    for(uint32_t page=0; page<disp.pages; ++page)
+        moved=moved && ram_rotated(&mock, page, disp.buffer+page*WIDTH, 8);
+    check("scroll_diagonal", moved);
+    check_golden("scroll_diagonal");
+
+    ssd1306_scroll_stop(&disp);
+    ssd1306_scroll_area(&disp, 0, 64);
+    ssd1306_show(&disp);
+    check("scroll_diagonal_stop", ssd1306_mock_matches(&mock, &disp));
+    reset_display();
+}
+
+/*
+ * bus faults injected by the mock: retried, recovered, or dropped and sent again
+ */
+
+static bool spans_clean(const ssd1306_t *p) {
+    for(uint32_t page=0; page<p->pages; ++page)
+        if(p->dirty_x0[page]<=p->dirty_x1[page])
+            return false;
+    return true;
+}
+
+static void test_faults(void) {
+    static ssd1306_mock_t m;
+    static ssd1306_t p;
+    ssd1306_mock_init(&m, 0);
+    if(!ssd1306_init_with_transport(&p, WIDTH, HEIGHT, &ssd1306_mock_transport, &m)) {
+        check("faults_init", false);
+        return;
+    }
+    ssd1306_clear(&p);
+    ssd1306_show(&p);
+
+    // a nack, retried once
+    ssd1306_stats_t before=p.stats;
+    m.fail_next=1;
+    ssd1306_draw_square(&p, 10, 10, 30, 20);
+    ssd1306_show(&p);
+    check("fault_nack_retried", p.stats.errors==before.errors+1 && p.stats.retries==before.retries+1
+          && p.stats.dropped==before.dropped && p.stats.last_error==SSD1306_MOCK_NACK
+          && m.delay_us>0 && ssd1306_mock_matches(&m, &p) && spans_clean(&p));
+
+    // a stuck bus, freed by the recovery before the last attempt
+    before=p.stats;
+    m.stuck=true;
+    ssd1306_draw_string(&p, 50, 40, 1, "stuck");
+    ssd1306_show(&p);
+    check("fault_stuck_recovered", !m.stuck && m.recoveries==1 && p.stats.recoveries==before.recoveries+1
+          && p.stats.failed_recoveries==before.failed_recoveries && p.stats.dropped==before.dropped
+          && ssd1306_mock_matches(&m, &p) && spans_clean(&p));
+
+    // the recovery fails too: the write is dropped, every span drawn stays dirty
+    before=p.stats;
+    m.stuck=true;
+    m.recover_fails=true;
+    ssd1306_draw_line(&p, 0, 63, 127, 0);
+    ssd1306_show(&p);
+    bool dirty=true;
+    for(uint32_t page=0; page<p.pages; ++page)
+        dirty=dirty && p.dirty_x0[page]<=p.dirty_x1[page];
+    check("fault_recovery_failed", p.stats.dropped==before.dropped+1
+          && p.stats.failed_recoveries==before.failed_recoveries+1
+          && p.stats.errors==before.errors+SSD1306_RETRIES+1 && p.stats.last_error==SSD1306_MOCK_TIMEOUT
+          && p.stats.last_show_bytes==0 && dirty && !ssd1306_mock_matches(&m, &p));
+
+    // the bus is back: the next show sends the dropped spans
+    before=p.stats;
+    m.stuck=false;
+    m.recover_fails=false;
+    ssd1306_show(&p);
+    check("fault_resent", p.stats.errors==before.errors && p.stats.last_show_bytes>0
+          && ssd1306_mock_matches(&m, &p) && spans_clean(&p));
+
+    ssd1306_deinit(&p);
+}
+
+/*
+ * paged show against show: same panel, first pixel on the bus sooner
+ */
+
+// the mock transport, noting when the first ram byte of a frame goes out
+typedef struct {
+    ssd1306_mock_t mock;
+    uint64_t first_data;	// now_ns of the first write_data since it was cleared, 0 if none yet
+} timed_mock_t;
+
+static int timed_write_cmds(void *ctx, const uint8_t *cmds, size_t len) {
+    return ssd1306_mock_transport.write_cmds(&((timed_mock_t *) ctx)->mock, cmds, len);
+}
+
+static int timed_write_data(void *ctx, uint8_t *data, size_t len) {
+    timed_mock_t *t=ctx;
+    if(!t->first_data)
+        t->first_data=now_ns();
+    return ssd1306_mock_transport.write_data(&t->mock, data, len);
+}
+
+static void timed_delay(void *ctx, uint32_t us) {
+    ssd1306_mock_transport.delay(&((timed_mock_t *) ctx)->mock, us);
+}
+
+static int timed_recover(void *ctx) {
+    return ssd1306_mock_transport.recover(&((timed_mock_t *) ctx)->mock);
+}
+
+static const ssd1306_transport_t timed_transport= {
+    .write_cmds=timed_write_cmds,
+    .write_data=timed_write_data,
+    .wait=NULL,
+    .delay=timed_delay,
+    .recover=timed_recover,
+};
+
+// a full screen of primitives, moving with the frame number; redraws everything inside the clip rows
+static void render_scene(ssd1306_t *p, void *ctx) {
+    const uint32_t i=*(const uint32_t *) ctx;
+    ssd1306_clear(p);
+    ssd1306_draw_empty_rounded_square(p, 0, 0, 128, 64, 6);
+    for(uint32_t k=0; k<6; ++k)
+        ssd1306_draw_line(p, 4+k*20, 60, 60+(i*7+k*9)%64, 4);
+    ssd1306_draw_circle(p, 20+(i*5)%90, 32, 12);
+    ssd1306_draw_string(p, 6, 6+(i&3)*14, 1, "ssd1306_show_paged");
+    ssd1306_bmp_show_image_with_offset(p, bmp, sizeof(bmp), 60, (i*3)&31);
+}
+
+static void test_paged(void) {
+    static timed_mock_t whole, paged;
+    static ssd1306_t pw, pp;
+    const uint32_t frames=quick?3:20;
+    uint64_t first[2]= {0}, total[2]= {0};
+    bool same=true;
+
+    // the bus time of i2c at 400 kHz, so the first pixel waits for the bytes sent before it
+    ssd1306_mock_init(&whole.mock, 0);
+    ssd1306_mock_init(&paged.mock, 0);
+    if(!ssd1306_init_with_transport(&pw, WIDTH, HEIGHT, &timed_transport, &whole)
+       || !ssd1306_init_with_transport(&pp, WIDTH, HEIGHT, &timed_transport, &paged)) {
+        check("paged_init", false);
+        return;
+    }
+    whole.mock.ns_per_byte=paged.mock.ns_per_byte=25000;
+
+    for(uint32_t i=0; i<frames; ++i) {
+        // every page changes, so both send the whole frame
+        ssd1306_invalidate(&pw);
+        ssd1306_invalidate(&pp);
+
+        whole.first_data=0;
+        uint64_t t0=now_ns();
+        render_scene(&pw, &i);
+        ssd1306_show(&pw);
+        first[0]+=whole.first_data-t0;
+        total[0]+=now_ns()-t0;
+
+        paged.first_data=0;
+        t0=now_ns();
+        ssd1306_show_paged(&pp, render_scene, &i);
+        first[1]+=paged.first_data-t0;
+        total[1]+=now_ns()-t0;
+
+        same=same && !memcmp(whole.mock.gddram, paged.mock.gddram, sizeof(whole.mock.gddram))
+             && !memcmp(pw.buffer, pp.buffer, WIDTH*HEIGHT/8) && ssd1306_mock_matches(&paged.mock, &pp)
+             && spans_clean(&pp) && pp.clip_y0==0 && pp.clip_y1==HEIGHT-1;
+    }
+
+    // and with only a part of the screen changing
+    for(uint32_t i=frames; i<frames+8; ++i) {
+        render_scene(&pw, &i);
+        ssd1306_show(&pw);
+        ssd1306_show_paged(&pp, render_scene, &i);
+        same=same && !memcmp(whole.mock.gddram, paged.mock.gddram, sizeof(whole.mock.gddram))
+             && ssd1306_mock_matches(&paged.mock, &pp) && spans_clean(&pp);
+    }
+    check("show_paged_panel", same);
+
+    add_result("paged", "show_first_pixel_400khz", (double) first[0]/frames, pw.stats.last_show_bytes, pw.stats.last_show_transactions);
+    add_result("paged", "show_paged_first_pixel_400khz", (double) first[1]/frames, pp.stats.last_show_bytes, pp.stats.last_show_transactions);
+    add_result("paged", "show_frame_400khz", (double) total[0]/frames, 0, 0);
+    add_result("paged", "show_paged_frame_400khz", (double) total[1]/frames, 0, 0);
+
+    ssd1306_deinit(&pw);
+    ssd1306_deinit(&pp);
+}
+
+static void print_json(FILE *f) {
+    fprintf(f, "{\n  \"mode\": \"%s\",\n  \"results\": [\n", quick?"quick":"full");
+    for(size_t i=0; i<result_count; ++i) {
+        const result_t *r=&results[i];
+        fprintf(f, "    {\"group\": \"%s\", \"name\": \"%s\", \"ns_per_op\": %.1f, \"bytes\": %.1f, \"transactions\": %.1f",
+                r->group, r->name, r->ns_per_op, r->bytes, r->transactions);
+        if(r->pixels)
+            fprintf(f, ", \"mpx_per_s\": %.1f", r->pixels*1000.0/r->ns_per_op);
+        fprintf(f, "}%s\n", i+1<result_count?",":"");
+    }
+    fprintf(f, "  ],\n  \"assets\": [\n");
+    for(size_t i=0; i<asset_size_count; ++i) {
+        const asset_size_t *a=&asset_sizes[i];
+        fprintf(f, "    {\"name\": \"%s\", \"bytes\": %zu, \"bmp_bytes\": %zu, \"ratio\": %.2f}%s\n",
+                a->name, a->bytes, a->bmp_bytes, (double) a->bytes/a->bmp_bytes, i+1<asset_size_count?",":"");
+    }
+    fprintf(f, "  ],\n  \"golden\": {\"checked\": %d, \"failed\": %d},\n", golden_checked, golden_failed);
+    fprintf(f, "  \"reference\": {\"checked\": %d, \"failed\": %d},\n", reference_checked, reference_failed);
+    fprintf(f, "  \"checks\": {\"checked\": %d, \"failed\": %d}\n}\n", checks_checked, checks_failed);
+}
+
+int main(int argc, char **argv) {
+    const char *json=NULL;
+
+    for(int i=1; i<argc; ++i) {
+        if(!strcmp(argv[i], "--quick")) {
+            quick=true;
+        } else if(!strcmp(argv[i], "--golden") && i+1<argc) {
+            golden_dir=argv[++i];
+        } else if(!strcmp(argv[i], "--update-golden") && i+1<argc) {
+            update_dir=argv[++i];
+        } else if(!strcmp(argv[i], "--json") && i+1<argc) {
+            json=argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--quick] [--golden DIR] [--update-golden DIR] [--json FILE]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    ssd1306_mock_init(&mock, 0);
+    if(!ssd1306_init_with_transport(&disp, WIDTH, HEIGHT, &ssd1306_mock_transport, &mock)) {
+        fprintf(stderr, "display initialization failed\n");
+        return 1;
+    }
+    if(!ssd1306_canvas_init(&canvas, WIDTH, HEIGHT, NULL) || !ssd1306_canvas_init(&ref_canvas, WIDTH, HEIGHT, NULL)) {
+        fprintf(stderr, "canvas initialization failed\n");
+        return 1;
+    }
+    make_bmp();
+
+    bench_primitives();
+    bench_frames();
+    bench_rectangles();
+    bench_lines();
+    bench_bmp();
+    test_assets();
+    test_text_cache();
+    test_xor();
+    bench_fixed();
+    test_blit();
+    test_scroll();
+    test_faults();
+    test_paged();
+
+    FILE *out=json?fopen(json, "w"):stdout;
+    if(!out) {
+        fprintf(stderr, "cannot write %s\n", json);
+        return 1;
+    }
+    print_json(out);
+    if(json)
+        fclose(out);
+
+    return golden_failed || reference_failed || checks_failed?1:0;
+}
@@ -0,0 +1,19 @@
+/**
+* @file rand.h
+*
+* host stand-in for the pico sdk random numbers: a fixed seed xorshift, so runs repeat
+*/
+
+#ifndef _inc_bench_pico_rand
+#define _inc_bench_pico_rand
+#include <stdint.h>
+
+static inline uint32_t get_rand_32(void) {
+    static uint32_t state=0x12345678u;
+    state^=state<<13;
+    state^=state>>17;
+    state^=state<<5;
+    return state;
+}
+
+#endif
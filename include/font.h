@@ -2,7 +2,7 @@
 #define _inc_font
 
 
-const uint8_t font_8x5[] = {
+static const uint8_t font_8x5[] = {
 			8, 5, 1, 32, 126,
 			0x00, 0x00, 0x00, 0x00, 0x00,
 			0x00, 0x00, 0x5F, 0x00, 0x00,
@@ -0,0 +1,118 @@
+/**
+ * @file keypad.h
+ *
+ * Teclado embaralhado: comandos do display, geração das matrizes e das sessões e a tela
+ * montada com widgets. Só o conjunto de comandos usa o FreeRTOS (uma fila de índices), então
+ * o firmware e o benchmark no host (bench/, no port POSIX) usam o mesmo código.
+ */
+
+#ifndef _inc_keypad
+#define _inc_keypad
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+
+#include "ssd1306.h"
+#include "ssd1306_ui.h"
+
+#define NUM_LINES 4
+#define NUMBERS_PER_LINE 4
+#define PIN_LENGTH 6
+#define TOTAL_CHARS 16
+#define DISPLAY_COMMANDS 14
+
+typedef enum {
+    DISP_ATUALIZAR_MATRIZ,
+    DISP_ATUALIZAR_SELECAO,
+    DISP_ATUALIZAR_SENHA,
+    DISP_MENSAGEM,
+    DISP_NUM_TIPOS
+} DisplayCommandType_t;
+
+typedef enum {
+    MENSAGEM_SENHA_CORRETA,
+    MENSAGEM_SENHA_INCORRETA
+} Mensagem_t;
+
+typedef struct {
+    DisplayCommandType_t tipo;
+    union {
+        char matriz[NUM_LINES][NUMBERS_PER_LINE];
+        uint8_t linha;
+        char senha[PIN_LENGTH+1];
+        Mensagem_t mensagem;
+    } data;
+} DisplayCommand_t;
+
+/**
+ * @brief Embaralha os 16 caracteres e monta uma matriz sem repetição entre linhas.
+ * @param matriz Matriz a preencher.
+ */
+void gerar_matriz(char matriz[NUM_LINES][NUMBERS_PER_LINE]);
+
+/**
+ * @brief Matrizes de todas as etapas da sessão atual e da próxima.
+ *
+ * Cada sessão pertence à task_randomizer enquanto é gerada e à task_auth depois.
+ */
+extern char sessoes[2][PIN_LENGTH][NUM_LINES][NUMBERS_PER_LINE];
+
+/**
+ * @brief Gera com antecedência as matrizes de todas as etapas de uma sessão.
+ * @param sessao Índice em sessoes.
+ */
+void gerar_sessao(uint8_t sessao);
+
+/**
+ * @brief Cria a fila dos comandos do display. Chamar antes de iniciar as tasks.
+ * @return false se não há memória para a fila.
+ */
+bool iniciar_comandos_display(void);
+
+/**
+ * @brief Reserva um comando livre para ser preenchido e enviado com enviar_comando_display.
+ *
+ * Só uma task pode reservar comandos (a task_auth).
+ *
+ * @param tipo Tipo do comando.
+ * @return Comando reservado, ou NULL se todos estão em uso (o comando é descartado, como numa fila cheia).
+ */
+DisplayCommand_t *reservar_comando_display(DisplayCommandType_t tipo);
+
+/**
+ * @brief Entrega um comando reservado à task de display, que o libera depois de aplicá-lo.
+ * @param cmd Comando preenchido.
+ */
+void enviar_comando_display(DisplayCommand_t *cmd);
+
+/**
+ * @brief Espera o próximo comando enviado.
+ * @param espera Ticks de espera.
+ * @return Comando recebido, a liberar com liberar_comando_display, ou NULL se o prazo acabou.
+ */
+DisplayCommand_t *receber_comando_display(TickType_t espera);
+
+/**
+ * @brief Devolve um comando para ser reservado de novo.
+ * @param cmd Comando recebido.
+ */
+void liberar_comando_display(DisplayCommand_t *cmd);
+
+/**
+ * @brief Monta a árvore de widgets: a matriz com cursor e senha, e a tela de mensagem.
+ * @param ui Interface a inicializar.
+ * @param disp Display inicializado.
+ */
+void montar_interface(ssd1306_ui_t *ui, ssd1306_t *disp);
+
+/**
+ * @brief Aplica um comando ao estado dos widgets, mesmo com a tela escondida.
+ *
+ * Só muda os widgets; ssd1306_ui_render desenha o que mudou.
+ *
+ * @param cmd Comando a aplicar.
+ */
+void aplicar_comando_display(const DisplayCommand_t *cmd);
+
+#endif
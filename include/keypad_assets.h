@@ -0,0 +1,43 @@
+// generated by tools/ssd1306_gen.py from keypad.assets, do not edit
+
+#ifndef _inc_keypad_assets
+#define _inc_keypad_assets
+#include <stdint.h>
+
+// ../include/font.h: 5x8, chars 32..70, 200 bytes
+static const uint8_t font_keypad[] = {
+    0x08, 0x05, 0x01, 0x20, 0x46, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x5F, 0x00, 0x00, 0x00,
+    0x07, 0x00, 0x07, 0x00, 0x14, 0x7F, 0x14, 0x7F, 0x14, 0x24, 0x2A, 0x7F, 0x2A, 0x12, 0x23, 0x13,
+    0x08, 0x64, 0x62, 0x36, 0x49, 0x56, 0x20, 0x50, 0x00, 0x08, 0x07, 0x03, 0x00, 0x00, 0x1C, 0x22,
+    0x41, 0x00, 0x00, 0x41, 0x22, 0x1C, 0x00, 0x2A, 0x1C, 0x7F, 0x1C, 0x2A, 0x08, 0x08, 0x3E, 0x08,
+    0x08, 0x00, 0x80, 0x70, 0x30, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x60, 0x60, 0x00,
+    0x20, 0x10, 0x08, 0x04, 0x02, 0x3E, 0x51, 0x49, 0x45, 0x3E, 0x00, 0x42, 0x7F, 0x40, 0x00, 0x72,
+    0x49, 0x49, 0x49, 0x46, 0x21, 0x41, 0x49, 0x4D, 0x33, 0x18, 0x14, 0x12, 0x7F, 0x10, 0x27, 0x45,
+    0x45, 0x45, 0x39, 0x3C, 0x4A, 0x49, 0x49, 0x31, 0x41, 0x21, 0x11, 0x09, 0x07, 0x36, 0x49, 0x49,
+    0x49, 0x36, 0x46, 0x49, 0x49, 0x29, 0x1E, 0x00, 0x00, 0x14, 0x00, 0x00, 0x00, 0x40, 0x34, 0x00,
+    0x00, 0x00, 0x08, 0x14, 0x22, 0x41, 0x14, 0x14, 0x14, 0x14, 0x14, 0x00, 0x41, 0x22, 0x14, 0x08,
+    0x02, 0x01, 0x59, 0x09, 0x06, 0x3E, 0x41, 0x5D, 0x59, 0x4E, 0x7C, 0x12, 0x11, 0x12, 0x7C, 0x7F,
+    0x49, 0x49, 0x49, 0x36, 0x3E, 0x41, 0x41, 0x41, 0x22, 0x7F, 0x41, 0x41, 0x41, 0x3E, 0x7F, 0x49,
+    0x49, 0x49, 0x41, 0x7F, 0x09, 0x09, 0x09, 0x01,
+};
+
+// "SENHA CORRETA" in ../include/font.h at scale 1: 77x8, 77 bytes
+static const uint8_t asset_senha_correta[] = {
+    0xA5, 0x4D, 0x08, 0x00, 0x26, 0x82, 0x49, 0x02, 0x32, 0x00, 0x7F, 0x82, 0x49, 0x08, 0x41, 0x00,
+    0x7F, 0x04, 0x08, 0x10, 0x7F, 0x00, 0x7F, 0x82, 0x08, 0x06, 0x7F, 0x00, 0x7C, 0x12, 0x11, 0x12,
+    0x7C, 0x86, 0x00, 0x00, 0x3E, 0x82, 0x41, 0x02, 0x22, 0x00, 0x3E, 0x82, 0x41, 0x0E, 0x3E, 0x00,
+    0x7F, 0x09, 0x19, 0x29, 0x46, 0x00, 0x7F, 0x09, 0x19, 0x29, 0x46, 0x00, 0x7F, 0x82, 0x49, 0x0C,
+    0x41, 0x00, 0x03, 0x01, 0x7F, 0x01, 0x03, 0x00, 0x7C, 0x12, 0x11, 0x12, 0x7C,
+};
+
+// "SENHA INCORRETA" in ../include/font.h at scale 1: 89x8, 88 bytes
+static const uint8_t asset_senha_incorreta[] = {
+    0xA5, 0x59, 0x08, 0x00, 0x26, 0x82, 0x49, 0x02, 0x32, 0x00, 0x7F, 0x82, 0x49, 0x08, 0x41, 0x00,
+    0x7F, 0x04, 0x08, 0x10, 0x7F, 0x00, 0x7F, 0x82, 0x08, 0x06, 0x7F, 0x00, 0x7C, 0x12, 0x11, 0x12,
+    0x7C, 0x87, 0x00, 0x0B, 0x41, 0x7F, 0x41, 0x00, 0x00, 0x7F, 0x04, 0x08, 0x10, 0x7F, 0x00, 0x3E,
+    0x82, 0x41, 0x02, 0x22, 0x00, 0x3E, 0x82, 0x41, 0x0E, 0x3E, 0x00, 0x7F, 0x09, 0x19, 0x29, 0x46,
+    0x00, 0x7F, 0x09, 0x19, 0x29, 0x46, 0x00, 0x7F, 0x82, 0x49, 0x0C, 0x41, 0x00, 0x03, 0x01, 0x7F,
+    0x01, 0x03, 0x00, 0x7C, 0x12, 0x11, 0x12, 0x7C,
+};
+
+#endif
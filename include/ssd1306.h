@@ -30,8 +30,11 @@ SOFTWARE.
 
 #ifndef _inc_ssd1306
 #define _inc_ssd1306
-#include <pico/stdlib.h>
-#include <hardware/i2c.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+struct i2c_inst;
 
 /**
 *	@brief defines commands used in ssd1306
@@ -53,9 +56,129 @@ typedef enum {
     SET_DISP_CLK_DIV = 0xD5,
     SET_PRECHARGE = 0xD9,
     SET_VCOM_DESEL = 0xDB,
-    SET_CHARGE_PUMP = 0x8D
+    SET_CHARGE_PUMP = 0x8D,
+    SET_HSCROLL = 0x26,
+    SET_VHSCROLL = 0x29,
+    SET_SCROLL = 0x2E,
+    SET_SCROLL_AREA = 0xA3
 } ssd1306_command_t;
 
+/**
+*	@brief maximum number of pages supported (64 pixel high displays)
+*/
+#define SSD1306_MAX_PAGES 8
+
+/**
+*	@brief bytes of storage needed for a buffer of the given size (includes one byte of transport headroom)
+*/
+#define SSD1306_BUFFER_SIZE(width, height) ((width)*((height)/8)+1)
+
+/**
+*	@brief bytes of storage needed for a canvas of the given size, any height up to 64
+*/
+#define SSD1306_CANVAS_SIZE(width, height) ((width)*(((height)+7)/8)+1)
+
+/**
+*	@brief first byte of an asset, see ssd1306_draw_asset
+*/
+#define SSD1306_ASSET_MAGIC 0xA5
+
+/**
+*	@brief size of the asset header (magic, width, height)
+*/
+#define SSD1306_ASSET_HEADER_SIZE 3
+
+/**
+*	@brief attempts after a failed transport write, before it is given up
+*/
+#ifndef SSD1306_RETRIES
+#define SSD1306_RETRIES 3
+#endif
+
+/**
+*	@brief delay before the first retry, doubled for each further one
+*/
+#ifndef SSD1306_RETRY_DELAY_US
+#define SSD1306_RETRY_DELAY_US 100
+#endif
+
+/**
+*	@brief transfer and error counters, updated by ssd1306_show and the command functions
+*/
+typedef struct {
+    uint32_t shows;				/**< number of calls to ssd1306_show */
+    uint32_t last_show_bytes;	/**< command and data bytes handed to the transport by the last show */
+    uint32_t total_bytes;		/**< command and data bytes handed to the transport by all shows */
+    uint32_t last_show_transactions;	/**< transport calls made by the last show */
+    uint32_t transactions;		/**< transport calls since initialization, one per command sequence or data span */
+    uint32_t errors;			/**< transport calls that failed */
+    uint32_t retries;			/**< failed calls that were tried again */
+    uint32_t recoveries;		/**< bus recoveries started by the driver */
+    uint32_t failed_recoveries;	/**< bus recoveries that did not free the bus */
+    uint32_t dropped;			/**< writes given up after SSD1306_RETRIES retries, their spans stay dirty */
+    int last_error;				/**< error code of the last failed call */
+} ssd1306_stats_t;
+
+/**
+*	@brief bus used to reach the display
+*
+*	write functions return the number of bytes written or a negative error code
+*/
+typedef struct {
+    int (*write_cmds)(void *ctx, const uint8_t *cmds, size_t len);	/**< send a command sequence, in one bus transaction where possible */
+    int (*write_data)(void *ctx, uint8_t *data, size_t len);		/**< send display ram bytes, data[-1] is free for a control byte and restored by the driver */
+    void (*wait)(void *ctx);	/**< wait for write_data to complete, NULL if writes block */
+    void (*delay)(void *ctx, uint32_t us);	/**< wait before retrying a failed write, NULL to retry at once */
+    int (*recover)(void *ctx);	/**< free a stuck bus, negative if that failed. NULL if not supported */
+} ssd1306_transport_t;
+
+/**
+*	@brief number of strings kept by a ssd1306_text_cache_t
+*/
+#define SSD1306_TEXT_CACHE_ENTRIES 8
+
+/**
+*	@brief longest string kept by a ssd1306_text_cache_t
+*/
+#define SSD1306_TEXT_CACHE_TEXT 23
+
+/**
+*	@brief largest rendered string (columns x pages) kept by a ssd1306_text_cache_t
+*/
+#define SSD1306_TEXT_CACHE_BYTES 192
+
+/**
+*	@brief a rendered string
+*/
+typedef struct {
+    const uint8_t *font;	/**< font the string was rendered with */
+    uint8_t scale;			/**< scale the string was rendered with */
+    uint8_t width;			/**< columns of data */
+    uint8_t pages;			/**< pages of data */
+    uint32_t used;			/**< last use (cache clock), 0 if empty */
+    char text[SSD1306_TEXT_CACHE_TEXT+1];	/**< the string */
+    uint8_t data[SSD1306_TEXT_CACHE_BYTES];	/**< page layout rendering, page by page */
+} ssd1306_text_cache_entry_t;
+
+/**
+*	@brief least recently used cache of rendered strings, see ssd1306_set_text_cache
+*/
+typedef struct {
+    ssd1306_text_cache_entry_t entries[SSD1306_TEXT_CACHE_ENTRIES];	/**< cached strings */
+    uint32_t clock;		/**< incremented on every lookup */
+    uint32_t hits;		/**< strings drawn from the cache */
+    uint32_t misses;	/**< strings rendered into the cache */
+} ssd1306_text_cache_t;
+
+/**
+*	@brief how the draw functions combine their pixels with the buffer
+*/
+typedef enum {
+    SSD1306_ROP_SET,	/**< light the pixels (or) */
+    SSD1306_ROP_CLEAR,	/**< turn the pixels off (and-not) */
+    SSD1306_ROP_XOR		/**< invert the pixels, drawing the same shape twice restores the buffer */
+} ssd1306_rop_t;
+
 /**
 *	@brief holds the configuration
 */
@@ -63,13 +186,34 @@ typedef struct {
     uint8_t width; 		/**< width of display */
     uint8_t height; 	/**< height of display */
     uint8_t pages;		/**< stores pages of display (calculated on initialization*/
-    uint8_t address; 	/**< i2c address of display*/
-    i2c_inst_t *i2c_i; 	/**< i2c connection instance */
+    const ssd1306_transport_t *transport;	/**< bus used to reach the display */
+    void *transport_ctx;	/**< argument passed to the transport functions */
+    bool owns_transport_ctx;	/**< transport_ctx was allocated by the driver (ssd1306_init) */
     bool external_vcc; 	/**< whether display uses external vcc */ 
     uint8_t *buffer;	/**< display buffer */
+    bool owns_buffer;	/**< buffer was allocated by the driver */
     size_t bufsize;		/**< buffer size */
+    uint8_t dirty_x0[SSD1306_MAX_PAGES];	/**< first changed column of each page (dirty_x0>dirty_x1 if clean) */
+    uint8_t dirty_x1[SSD1306_MAX_PAGES];	/**< last changed column of each page */
+    uint8_t *front;		/**< front buffer being sent, NULL if not double buffered */
+    bool owns_front;	/**< front buffer was allocated by the driver */
+    uint8_t front_x0[SSD1306_MAX_PAGES];	/**< first column of each page of the front buffer still to be sent */
+    uint8_t front_x1[SSD1306_MAX_PAGES];	/**< last column of each page of the front buffer still to be sent */
+    ssd1306_stats_t stats;	/**< transfer counters */
+    ssd1306_text_cache_t *text_cache;	/**< cache used by the draw_string functions, NULL if none */
+    uint8_t start_line;	/**< ram row shown on the first row of the display (SET_DISP_START_LINE) */
+    uint8_t clip_y0;	/**< first row drawing functions may change */
+    uint8_t clip_y1;	/**< last row drawing functions may change */
+    ssd1306_rop_t rop;	/**< raster op of the draw functions (ssd1306_set_rop) */
+    void (*show_hook)(void *ctx, const uint8_t *frame);	/**< called with each frame that reached the display, NULL if none (ssd1306_set_show_hook) */
+    void *show_hook_ctx;	/**< argument passed to show_hook */
 } ssd1306_t;
 
+/**
+*	@brief draws a frame, called by ssd1306_show_paged once per page with the clip rows set to that page
+*/
+typedef void (*ssd1306_render_t)(ssd1306_t *p, void *ctx);
+
 /**
 *	@brief initialize display
 *
@@ -83,10 +227,62 @@ typedef struct {
 *	@retval true for Success
 *	@retval false if initialization failed
 */
-bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address, i2c_inst_t *i2c_instance);
+bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address, struct i2c_inst *i2c_instance);
 
 /**
-*	@brief deinitialize display
+*	@brief initialize display on any transport
+*
+*	@param[in] p : pointer to instance of ssd1306_t
+*	@param[in] width : width of display
+*	@param[in] height : heigth of display
+*	@param[in] transport : bus functions, see ssd1306_i2c.h, ssd1306_spi.h and ssd1306_mock.h
+*	@param[in] transport_ctx : argument passed to the bus functions
+*	
+* 	@return bool.
+*	@retval true for Success
+*	@retval false if initialization failed
+*/
+bool ssd1306_init_with_transport(ssd1306_t *p, uint16_t width, uint16_t height, const ssd1306_transport_t *transport, void *transport_ctx);
+
+/**
+*	@brief initialize display on caller provided storage, without using the heap
+*
+*	displays are independent of each other, several can be driven from one task
+*	(on one i2c bus they only need different addresses)
+*
+*	@param[in] p : pointer to instance of ssd1306_t
+*	@param[in] width : width of display
+*	@param[in] height : heigth of display
+*	@param[in] storage : SSD1306_BUFFER_SIZE(width, height) bytes, NULL to allocate them
+*	@param[in] transport : bus functions, see ssd1306_i2c.h, ssd1306_spi.h and ssd1306_mock.h
+*	@param[in] transport_ctx : argument passed to the bus functions
+*	
+* 	@return bool.
+*	@retval true for Success
+*	@retval false if allocation failed or the display did not take the setup commands
+*	(p is still set up, see p->stats, and can be initialized again or freed with ssd1306_deinit)
+*/
+bool ssd1306_init_static(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t *storage, const ssd1306_transport_t *transport, void *transport_ctx);
+
+/**
+*	@brief initialize an off-screen canvas
+*
+*	a canvas is a ssd1306_t without a display: all draw functions accept it, show does nothing.
+*	pre-render static parts once and copy them to a display with ssd1306_blit
+*
+*	@param[in] p : pointer to instance of ssd1306_t
+*	@param[in] width : width of canvas, 1..255
+*	@param[in] height : heigth of canvas, 1..64
+*	@param[in] storage : SSD1306_CANVAS_SIZE(width, height) bytes, NULL to allocate them
+*	
+* 	@return bool.
+*	@retval true for Success
+*	@retval false if the size is not supported or allocation failed
+*/
+bool ssd1306_canvas_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t *storage);
+
+/**
+*	@brief deinitialize display, frees only the buffers allocated by the driver
 *
 *	@param[in] p : instance of display
 *
@@ -127,14 +323,189 @@ void ssd1306_contrast(ssd1306_t *p, uint8_t val);
 */
 void ssd1306_invert(ssd1306_t *p, uint8_t inv);
 
+/**
+	@brief set how the draw functions combine their pixels with the buffer
+
+	applies to pixels, lines, squares, circles, glyphs, bitmaps and assets. the clear functions
+	always turn pixels off. every pixel of a shape is drawn once, so with SSD1306_ROP_XOR
+	drawing a shape again removes it
+
+	@param[in] p : instance of display
+	@param[in] rop : raster op, SSD1306_ROP_SET after initialization
+
+*/
+void ssd1306_set_rop(ssd1306_t *p, ssd1306_rop_t rop);
+
+/**
+	@brief set the ram row shown on the first row of the display
+
+	the buffer follows the start line in whole pages: page n of the buffer is sent to
+	ram page (n+start_line/8)%8. the remaining start_line%8 rows move the picture up
+	without resending it, for animating between page steps
+
+	@param[in] p : instance of display
+	@param[in] line : 0..63
+
+*/
+void ssd1306_set_start_line(ssd1306_t *p, uint8_t line);
+
+/**
+	@brief move the picture up (pages>0) or down (pages<0) by whole pages
+
+	moves the buffer, clears the pages scrolled in and moves the start line of the panel,
+	so the next show only sends the pages scrolled in. with a front buffer, wait for the
+	running flush before scrolling
+
+	@param[in] p : instance of display
+	@param[in] pages : pages to scroll
+
+*/
+void ssd1306_scroll_pages(ssd1306_t *p, int32_t pages);
+
+/**
+	@brief start continuous horizontal scrolling of ram pages
+
+	the panel moves the ram content itself, stop with ssd1306_scroll_stop
+
+	@param[in] p : instance of display
+	@param[in] left : scroll to the left instead of the right
+	@param[in] start_page : first ram page
+	@param[in] end_page : last ram page
+	@param[in] interval : frames between steps, datasheet code 0..7 (7: 2, 4: 3, 5: 4, 0: 5, 6: 25, 1: 64, 2: 128, 3: 256)
+
+*/
+void ssd1306_scroll_horizontal(ssd1306_t *p, bool left, uint8_t start_page, uint8_t end_page, uint8_t interval);
+
+/**
+	@brief start continuous diagonal scrolling: horizontal on the pages, vertical in the scroll area
+
+	@param[in] p : instance of display
+	@param[in] left : scroll to the left instead of the right
+	@param[in] start_page : first ram page
+	@param[in] end_page : last ram page
+	@param[in] interval : frames between steps, see ssd1306_scroll_horizontal
+	@param[in] vertical_offset : rows per step, 0..63
+
+*/
+void ssd1306_scroll_diagonal(ssd1306_t *p, bool left, uint8_t start_page, uint8_t end_page, uint8_t interval, uint8_t vertical_offset);
+
+/**
+	@brief set the rows scrolled vertically by ssd1306_scroll_diagonal
+
+	@param[in] p : instance of display
+	@param[in] top_fixed : rows on top that do not scroll
+	@param[in] rows : rows of the scroll area
+
+*/
+void ssd1306_scroll_area(ssd1306_t *p, uint8_t top_fixed, uint8_t rows);
+
+/**
+	@brief stop continuous scrolling
+
+	the panel does not restore the ram it scrolled, the next show sends the full frame
+
+	@param[in] p : instance of display
+
+*/
+void ssd1306_scroll_stop(ssd1306_t *p);
+
 /**
 	@brief display buffer, should be called on change
 
+	only the column spans of each page changed since the last show are sent.
+	with a front buffer this is ssd1306_commit followed by ssd1306_flush.
+	failed writes are retried, and spans that still cannot be sent stay dirty for the next show
+
 	@param[in] p : instance of display
 
 */
 void ssd1306_show(ssd1306_t *p);
 
+/**
+	@brief draw and send the frame one page at a time
+
+	render is called for each page with drawing clipped to its rows, and should draw the whole frame.
+	the changed span of a page is sent as soon as it is drawn, and with a transport that has a wait
+	function the next page is drawn while it is on the bus. the first rows reach the panel after
+	one eighth of the drawing instead of after all of it.
+	with a front buffer, spans queued by ssd1306_commit must have been flushed
+
+	@param[in] p : instance of display
+	@param[in] render : draws the frame
+	@param[in] ctx : argument passed to render
+
+*/
+void ssd1306_show_paged(ssd1306_t *p, ssd1306_render_t render, void *ctx);
+
+/**
+	@brief allocate a front buffer, so a frame can be sent while the next one is drawn
+
+	@param[in] p : instance of display
+
+	@return bool.
+	@retval true for Success
+	@retval false if allocation failed
+*/
+bool ssd1306_enable_double_buffer(ssd1306_t *p);
+
+/**
+	@brief use caller provided storage as front buffer
+
+	the front buffer only carries spans between ssd1306_commit and ssd1306_flush, so
+	displays of the same size that are shown one after another from the same task
+	(ssd1306_show) can share one storage
+
+	@param[in] p : instance of display
+	@param[in] storage : SSD1306_BUFFER_SIZE(width, height) bytes
+
+	@return bool.
+	@retval true for Success
+*/
+bool ssd1306_enable_double_buffer_static(ssd1306_t *p, uint8_t *storage);
+
+/**
+	@brief hand the frame drawn so far to the front buffer
+
+	copies the changed spans of the buffer to the front buffer and queues them for ssd1306_flush.
+	drawing can continue on the buffer while the front buffer is flushed.
+	requires ssd1306_enable_double_buffer
+
+	@param[in] p : instance of display
+
+*/
+void ssd1306_commit(ssd1306_t *p);
+
+/**
+	@brief send the spans queued by ssd1306_commit
+
+	requires ssd1306_enable_double_buffer
+
+	@param[in] p : instance of display
+
+*/
+void ssd1306_flush(ssd1306_t *p);
+
+/**
+	@brief mark a region of the buffer as changed
+
+	use after writing to p->buffer directly, so the region is sent by the next show
+
+	@param[in] p : instance of display
+	@param[in] x0 : first column
+	@param[in] y0 : first row
+	@param[in] x1 : last column (inclusive)
+	@param[in] y1 : last row (inclusive)
+*/
+void ssd1306_mark_dirty(ssd1306_t *p, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1);
+
+/**
+	@brief mark the whole buffer as changed, next show sends the full frame
+
+	@param[in] p : instance of display
+
+*/
+void ssd1306_invalidate(ssd1306_t *p);
+
 /**
 	@brief clear display buffer
 
@@ -205,6 +576,50 @@ void ssd1306_draw_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, u
 */
 void ssd1306_draw_empty_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height);
 
+/**
+	@brief draw filled circle
+
+	@param[in] p : instance of display
+	@param[in] x : x position of center
+	@param[in] y : y position of center
+	@param[in] r : radius (at most 127)
+*/
+void ssd1306_draw_circle(ssd1306_t *p, int32_t x, int32_t y, uint32_t r);
+
+/**
+	@brief draw circle outline
+
+	@param[in] p : instance of display
+	@param[in] x : x position of center
+	@param[in] y : y position of center
+	@param[in] r : radius (at most 127)
+*/
+void ssd1306_draw_empty_circle(ssd1306_t *p, int32_t x, int32_t y, uint32_t r);
+
+/**
+	@brief draw filled square with rounded corners, covering width x height pixels
+
+	@param[in] p : instance of display
+	@param[in] x : x position of starting point
+	@param[in] y : y position of starting point
+	@param[in] width : width of square
+	@param[in] height : height of square
+	@param[in] r : corner radius (reduced if the corners do not fit)
+*/
+void ssd1306_draw_rounded_square(ssd1306_t *p, int32_t x, int32_t y, uint32_t width, uint32_t height, uint32_t r);
+
+/**
+	@brief draw outline of square with rounded corners, covering width x height pixels
+
+	@param[in] p : instance of display
+	@param[in] x : x position of starting point
+	@param[in] y : y position of starting point
+	@param[in] width : width of square
+	@param[in] height : height of square
+	@param[in] r : corner radius (reduced if the corners do not fit)
+*/
+void ssd1306_draw_empty_rounded_square(ssd1306_t *p, int32_t x, int32_t y, uint32_t width, uint32_t height, uint32_t r);
+
 /**
 	@brief draw monochrome bitmap with offset
 
@@ -225,6 +640,62 @@ void ssd1306_bmp_show_image_with_offset(ssd1306_t *p, const uint8_t *data, const
 */
 void ssd1306_bmp_show_image(ssd1306_t *p, const uint8_t *data, const long size);
 
+/**
+	@brief copy a canvas to a display or another canvas at any position
+
+	with SSD1306_ROP_SET the pixels under the mask are copied (lit and dark), with SSD1306_ROP_CLEAR
+	and SSD1306_ROP_XOR the lit pixels of src under the mask are cleared or inverted
+
+	@param[in] p : instance of display or canvas drawn to
+	@param[in] x : column of the left edge of src
+	@param[in] y : row of the top edge of src
+	@param[in] src : canvas to copy, not p
+	@param[in] mask : canvas of the size of src, only its lit pixels are copied. NULL to copy the whole canvas
+*/
+void ssd1306_blit(ssd1306_t *p, int32_t x, int32_t y, const ssd1306_t *src, const ssd1306_t *mask);
+
+/**
+	@brief draw compressed image (asset) at any position
+
+	assets are made by tools/ssd1306_asset.py: a header of SSD1306_ASSET_MAGIC, width and height,
+	then the page layout bytes (page by page, left to right) packed in blocks: a control byte c
+	followed by (c&0x7F)+1 literal bytes if c<0x80, or by one byte repeated (c&0x7F)+1 times.
+	decoding streams straight into the buffer, lit pixels are drawn and the rest is left untouched
+
+	@param[in] p : instance of display
+	@param[in] x : x position of the left edge
+	@param[in] y : y position of the top edge
+	@param[in] data : asset
+	@param[in] size : size of asset in bytes
+*/
+void ssd1306_draw_asset(ssd1306_t *p, int32_t x, int32_t y, const uint8_t *data, size_t size);
+
+/**
+	@brief cache rendered strings, so redrawing a string is a copy of its page bytes
+
+	strings up to SSD1306_TEXT_CACHE_TEXT characters and SSD1306_TEXT_CACHE_BYTES rendered bytes
+	are cached per font and scale (1 to 4). a cache may be shared by displays used from the same task
+
+	@param[in] p : instance of display
+	@param[in] cache : cache to use (cleared here), NULL to disable caching
+*/
+void ssd1306_set_text_cache(ssd1306_t *p, ssd1306_text_cache_t *cache);
+
+/**
+	@brief call a function with every frame that reached the display
+
+	the hook runs at the end of ssd1306_show, ssd1306_flush and ssd1306_show_paged, in the task that
+	called them, when something was sent and no write was dropped. frame is the buffer that was sent
+	(the front buffer if double buffered), pages*width bytes in the layout of the display ram. it must
+	not be kept after the hook returns. displays sharing a front buffer storage do not hand their
+	own frame. see ssd1306_mirror.h
+
+	@param[in] p : instance of display
+	@param[in] hook : function to call, NULL to remove it
+	@param[in] ctx : argument passed to hook
+*/
+void ssd1306_set_show_hook(ssd1306_t *p, void (*hook)(void *ctx, const uint8_t *frame), void *ctx);
+
 /**
 	@brief draw char with given font
 
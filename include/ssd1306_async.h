@@ -0,0 +1,58 @@
+/**
+* @file ssd1306_async.h
+*
+* flushes a double buffered ssd1306 from a dedicated FreeRTOS task
+*/
+
+#ifndef _inc_ssd1306_async
+#define _inc_ssd1306_async
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include "ssd1306.h"
+
+/**
+*	@brief state of the flush task
+*/
+typedef struct {
+    ssd1306_t *disp;			/**< display being flushed */
+    TaskHandle_t task;			/**< flush task */
+    SemaphoreHandle_t idle;		/**< available while no flush is in progress */
+} ssd1306_async_t;
+
+/**
+	@brief enable double buffering on the display and start its flush task
+
+	the front buffer is allocated unless ssd1306_enable_double_buffer_static was called before
+
+	@param[in] a : flush task state, must outlive the task
+	@param[in] p : initialized instance of display
+	@param[in] priority : priority of the flush task
+
+	@return bool.
+	@retval true for Success
+	@retval false if the front buffer, semaphore or task could not be allocated
+*/
+bool ssd1306_async_start(ssd1306_async_t *a, ssd1306_t *p, UBaseType_t priority);
+
+/**
+	@brief send the frame drawn so far without waiting for the bus
+
+	waits only if the previous frame is still being sent, then commits the buffer
+	and wakes the flush task. drawing can continue right after this returns
+
+	@param[in] a : flush task state
+*/
+void ssd1306_async_show(ssd1306_async_t *a);
+
+/**
+	@brief wait until the flush task is done with the bus
+
+	call before issuing commands (contrast, invert, power) from another task
+
+	@param[in] a : flush task state
+*/
+void ssd1306_async_wait(ssd1306_async_t *a);
+
+#endif
@@ -0,0 +1,64 @@
+/**
+* @file ssd1306_fixed.h
+*
+* pixel functions specialized for one display geometry
+*
+* SSD1306_DEFINE_FIXED(oled, 128, 64) defines static inline oled_* functions for 128x64 displays:
+* the buffer index is computed from constants and the column bound is a constant compare.
+* the _unchecked variants drop the bounds checks, for coordinates known to be inside the display
+* and the clip rows. they work on the same ssd1306_t as the rest of the api, keeping dirty
+* tracking, clip rows and raster op, so both can be mixed on one display
+*/
+
+#ifndef _inc_ssd1306_fixed
+#define _inc_ssd1306_fixed
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ssd1306.h"
+#include "ssd1306_internal.h"
+
+/**
+*	@brief define the functions of a fixed geometry
+*
+*	prefix##_init(p, storage, transport, ctx) : ssd1306_init_static with the geometry
+*	prefix##_draw_pixel(p, x, y), prefix##_draw_pixel_unchecked(p, x, y) : draw with the raster op
+*	prefix##_clear_pixel(p, x, y), prefix##_clear_pixel_unchecked(p, x, y) : turn off
+*	prefix##_get_pixel(p, x, y) : whether the pixel is lit, false outside
+*
+*	@param prefix : name prefix of the functions
+*	@param W : width of display
+*	@param H : height of display, multiple of 8
+*/
+#define SSD1306_DEFINE_FIXED(prefix, W, H)																\
+    _Static_assert((W)>0 && (W)<=128 && (H)>0 && (H)<=64 && (H)%8==0, "unsupported ssd1306 geometry");	\
+    enum { prefix##_WIDTH=(W), prefix##_HEIGHT=(H), prefix##_BUFFER_SIZE=SSD1306_BUFFER_SIZE(W, H) };	\
+																										\
+    inline static bool prefix##_init(ssd1306_t *p, uint8_t *storage, const ssd1306_transport_t *transport, void *ctx) {	\
+        return ssd1306_init_static(p, (W), (H), storage, transport, ctx);								\
+    }																									\
+																										\
+    inline static void prefix##_draw_pixel_unchecked(ssd1306_t *p, uint32_t x, uint32_t y) {			\
+        ssd1306_plot_w(p, (W), x, y);																	\
+    }																									\
+																										\
+    inline static void prefix##_draw_pixel(ssd1306_t *p, uint32_t x, uint32_t y) {						\
+        if(x>=(W) || y<p->clip_y0 || y>p->clip_y1) return;											\
+        prefix##_draw_pixel_unchecked(p, x, y);															\
+    }																									\
+																										\
+    inline static void prefix##_clear_pixel_unchecked(ssd1306_t *p, uint32_t x, uint32_t y) {			\
+        ssd1306_unplot_w(p, (W), x, y);																	\
+    }																									\
+																										\
+    inline static void prefix##_clear_pixel(ssd1306_t *p, uint32_t x, uint32_t y) {						\
+        if(x>=(W) || y<p->clip_y0 || y>p->clip_y1) return;											\
+        prefix##_clear_pixel_unchecked(p, x, y);														\
+    }																									\
+																										\
+    inline static bool prefix##_get_pixel(const ssd1306_t *p, uint32_t x, uint32_t y) {				\
+        if(x>=(W) || y>=(H)) return false;																\
+        return (p->buffer[x+(W)*(y>>3)]>>(y&0x07))&1;													\
+    }
+
+#endif
@@ -0,0 +1,59 @@
+/**
+* @file ssd1306_i2c.h
+*
+* i2c transport for ssd1306 displays (Raspberry Pi Pico)
+*/
+
+#ifndef _inc_ssd1306_i2c
+#define _inc_ssd1306_i2c
+#include <hardware/i2c.h>
+
+#include "ssd1306.h"
+
+/**
+*	@brief i2c connection, the i2c instance and its pins must already be set up
+*/
+typedef struct {
+    i2c_inst_t *i2c;	/**< i2c connection instance */
+    uint8_t address;	/**< i2c address of display */
+    uint sda;			/**< sda pin for bus recovery (ssd1306_i2c_enable_recovery) */
+    uint scl;			/**< scl pin for bus recovery */
+    uint baudrate;		/**< baudrate to set the i2c instance up with after a recovery, 0 if not enabled */
+} ssd1306_i2c_t;
+
+/**
+*	@brief i2c transport, its context is a ssd1306_i2c_t
+*
+*	set up by ssd1306_init and ssd1306_init_i2c_static
+*/
+extern const ssd1306_transport_t ssd1306_i2c_transport;
+
+/**
+*	@brief initialize display over i2c on caller provided storage, without using the heap
+*
+*	@param[in] p : pointer to instance of ssd1306_t
+*	@param[in] width : width of display
+*	@param[in] height : heigth of display
+*	@param[out] bus : i2c connection to set up, must outlive the display
+*	@param[in] address : i2c address of display
+*	@param[in] i2c_instance : instance of i2c connection
+*	@param[in] storage : SSD1306_BUFFER_SIZE(width, height) bytes, NULL to allocate them
+*	
+* 	@return bool.
+*	@retval true for Success
+*	@retval false if initialization failed
+*/
+bool ssd1306_init_i2c_static(ssd1306_t *p, uint16_t width, uint16_t height, ssd1306_i2c_t *bus, uint8_t address, i2c_inst_t *i2c_instance, uint8_t *storage);
+
+/**
+*	@brief let the driver free a stuck bus: scl is clocked until the display releases sda,
+*	then the i2c peripheral is set up again
+*
+*	@param[in] bus : i2c connection set up by ssd1306_init_i2c_static
+*	@param[in] sda : sda pin of the i2c instance
+*	@param[in] scl : scl pin of the i2c instance
+*	@param[in] baudrate : baudrate the i2c instance was initialized with
+*/
+void ssd1306_i2c_enable_recovery(ssd1306_i2c_t *bus, uint sda, uint scl, uint baudrate);
+
+#endif
@@ -0,0 +1,54 @@
+/**
+* @file ssd1306_internal.h
+*
+* buffer helpers shared by ssd1306.c and the fixed geometry functions of ssd1306_fixed.h,
+* not part of the api
+*/
+
+#ifndef _inc_ssd1306_internal
+#define _inc_ssd1306_internal
+#include <stdint.h>
+
+#include "ssd1306.h"
+
+// widens the dirty span of page to cover columns x0..x1
+inline static void ssd1306_dirty_span(ssd1306_t *p, uint32_t page, uint32_t x0, uint32_t x1) {
+    if(x0<p->dirty_x0[page])
+        p->dirty_x0[page]=x0;
+    if(x1>p->dirty_x1[page])
+        p->dirty_x1[page]=x1;
+}
+
+// combines the bits of mask into b
+inline static uint32_t ssd1306_apply_rop(ssd1306_rop_t rop, uint32_t b, uint32_t mask) {
+    switch(rop) {
+    case SSD1306_ROP_CLEAR:
+        return b&~mask;
+    case SSD1306_ROP_XOR:
+        return b^mask;
+    default:
+        return b|mask;
+    }
+}
+
+// draws pixel (x, y) with the raster op of p on a buffer width columns wide (p->width, or the
+// constant of a fixed geometry), the pixel must be inside the display and the clip rows
+inline static void ssd1306_plot_w(ssd1306_t *p, uint32_t width, uint32_t x, uint32_t y) {
+    uint8_t *b=&p->buffer[x+width*(y>>3)]; // y>>3==y/8 && y&0x7==y%8
+    const uint8_t n=ssd1306_apply_rop(p->rop, *b, 0x1<<(y&0x07));
+    if(n!=*b) {
+        *b=n;
+        ssd1306_dirty_span(p, y>>3, x, x);
+    }
+}
+
+// turns pixel (x, y) off, same conditions as ssd1306_plot_w
+inline static void ssd1306_unplot_w(ssd1306_t *p, uint32_t width, uint32_t x, uint32_t y) {
+    uint8_t *b=&p->buffer[x+width*(y>>3)];
+    if(*b&(0x1<<(y&0x07))) {
+        *b&=~(0x1<<(y&0x07));
+        ssd1306_dirty_span(p, y>>3, x, x);
+    }
+}
+
+#endif
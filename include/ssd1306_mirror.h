@@ -0,0 +1,97 @@
+/**
+* @file ssd1306_mirror.h
+*
+* prints what a ssd1306 shows to stdio, for debugging without a camera
+*
+* every frame that reaches the display is xor-ed with the previous one and the difference is
+* compressed with the block format of the assets (see ssd1306_draw_asset): a byte n<0x80 is
+* followed by n+1 literal bytes, a byte n>=0x80 by one byte repeated n-0x7F times. unchanged
+* bytes at the end are left out. frames go through a FreeRTOS stream buffer to a low priority
+* task that prints one line per frame:
+*
+*	@OLED <K|D> <seq> <width>x<height> <hex>
+*
+* K frames are the difference to a blank display and are sent first and every
+* SSD1306_MIRROR_KEYFRAME_INTERVAL frames, D frames are the difference to the previous line.
+* tools/ssd1306_mirror.py rebuilds the frames on the host
+*/
+
+#ifndef _inc_ssd1306_mirror
+#define _inc_ssd1306_mirror
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stream_buffer.h"
+
+#include "ssd1306.h"
+
+/**
+*	@brief largest frame mirrored (128x64)
+*/
+#define SSD1306_MIRROR_FRAME (128*SSD1306_MAX_PAGES)
+
+/**
+*	@brief bytes in front of each encoded frame in the stream buffer (kind, sequence, length)
+*/
+#define SSD1306_MIRROR_HEADER 4
+
+/**
+*	@brief largest encoding of a frame of n bytes
+*/
+#define SSD1306_MIRROR_MAX_ENCODED(n) ((n)+((n)+127)/128)
+
+/**
+*	@brief size of a printed line: "@OLED K seq WxH ", two hex digits per encoded byte and '\n'
+*/
+#define SSD1306_MIRROR_LINE (32+2*SSD1306_MIRROR_MAX_ENCODED(SSD1306_MIRROR_FRAME)+1)
+
+/**
+*	@brief size of the stream buffer, at least one worst case frame
+*/
+#ifndef SSD1306_MIRROR_STREAM_SIZE
+#define SSD1306_MIRROR_STREAM_SIZE 2048
+#endif
+
+/**
+*	@brief frames between two K frames, so a host that attached late or lost a line catches up
+*/
+#ifndef SSD1306_MIRROR_KEYFRAME_INTERVAL
+#define SSD1306_MIRROR_KEYFRAME_INTERVAL 32
+#endif
+
+/**
+*	@brief state of the mirror
+*/
+typedef struct {
+    ssd1306_t *disp;			/**< display being mirrored */
+    StreamBufferHandle_t stream;	/**< encoded frames waiting to be printed */
+    TaskHandle_t task;			/**< print task */
+    uint32_t frames;			/**< frames queued for printing */
+    uint32_t keyframes;			/**< K frames among them */
+    uint32_t dropped;			/**< frames not queued because the stream buffer was full */
+    uint32_t bytes;				/**< encoded bytes queued */
+    uint8_t seq;				/**< sequence number of the next frame */
+    uint8_t since_key;			/**< frames queued since the last K frame */
+    uint8_t align;				/**< address of the last frame modulo 4 */
+    bool key;					/**< next frame is a K frame */
+    uint32_t ref[SSD1306_MIRROR_FRAME/4+1];	/**< last frame queued, at the alignment of the frames */
+    uint8_t msg[SSD1306_MIRROR_HEADER+SSD1306_MIRROR_MAX_ENCODED(SSD1306_MIRROR_FRAME)];	/**< frame being encoded */
+    char line[SSD1306_MIRROR_LINE];	/**< line being printed, written with one call */
+} ssd1306_mirror_t;
+
+/**
+	@brief start mirroring a display
+
+	installs the show hook of the display. the hook only encodes and queues the frame, without
+	waiting: if the print task falls behind, frames are dropped and the next one carries their changes
+
+	@param[in] m : mirror state, must outlive the task
+	@param[in] p : initialized instance of display
+	@param[in] priority : priority of the print task, below the tasks drawing the display
+
+	@return bool.
+	@retval true for Success
+	@retval false if the stream buffer or task could not be allocated
+*/
+bool ssd1306_mirror_start(ssd1306_mirror_t *m, ssd1306_t *p, UBaseType_t priority);
+
+#endif
@@ -0,0 +1,118 @@
+/**
+* @file ssd1306_mock.h
+*
+* in-memory transport that emulates the panel, for running the driver on a host
+*/
+
+#ifndef _inc_ssd1306_mock
+#define _inc_ssd1306_mock
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "ssd1306.h"
+
+/**
+*	@brief columns of the panel ram (64 pixel wide displays use columns 32..95)
+*/
+#define SSD1306_MOCK_COLUMNS 128
+
+/**
+*	@brief error returned by a write the panel did not acknowledge
+*/
+#define SSD1306_MOCK_NACK -1
+
+/**
+*	@brief error returned by writes while the bus is stuck
+*/
+#define SSD1306_MOCK_TIMEOUT -2
+
+/**
+*	@brief emulated panel, the context of ssd1306_mock_transport
+*/
+typedef struct {
+    uint8_t gddram[SSD1306_MAX_PAGES][SSD1306_MOCK_COLUMNS];	/**< mirror of the panel ram */
+    uint8_t col_start, col_end;		/**< column window (SET_COL_ADDR) */
+    uint8_t page_start, page_end;	/**< page window (SET_PAGE_ADDR) */
+    uint8_t col, page;				/**< ram write position */
+    uint8_t cmd[8];					/**< command being received */
+    size_t cmd_len;					/**< bytes of cmd received so far */
+    bool display_on;				/**< SET_DISP state */
+    bool inverted;					/**< SET_NORM_INV state */
+    uint8_t contrast;				/**< SET_CONTRAST value */
+    uint8_t start_line;				/**< SET_DISP_START_LINE value */
+    bool scrolling;					/**< continuous scrolling active (SET_SCROLL) */
+    bool scroll_left;				/**< scroll direction of the last scroll setup */
+    uint8_t scroll_start_page, scroll_end_page;	/**< ram pages scrolled horizontally */
+    uint8_t scroll_interval;		/**< frame interval code of the scroll setup */
+    uint8_t scroll_vertical;		/**< rows per step of a diagonal scroll, 0 if horizontal */
+    uint8_t scroll_top, scroll_rows;	/**< vertical scroll area (SET_SCROLL_AREA) */
+    uint8_t scroll_offset;			/**< rows the scroll area has moved so far */
+    uint32_t writes_while_scrolling;	/**< ram writes received with scrolling active */
+    uint32_t cmd_bytes;				/**< command bytes received */
+    uint32_t data_bytes;			/**< ram bytes received */
+    uint32_t cmd_transactions;		/**< calls to write_cmds */
+    uint32_t data_transactions;		/**< calls to write_data */
+    uint32_t ns_per_byte;			/**< simulated bus time per byte, write_data sleeps for it if non zero */
+    uint64_t bus_ns;				/**< simulated bus time of all writes */
+    uint32_t fail_next;				/**< fault injection: the next writes fail with SSD1306_MOCK_NACK */
+    uint32_t fail_every;			/**< fault injection: every fail_every-th write fails, 0 for never */
+    bool stuck;						/**< fault injection: writes time out until the bus is recovered */
+    bool recover_fails;				/**< fault injection: recovering leaves the bus stuck */
+    uint32_t writes;				/**< write calls, including failed ones */
+    uint32_t failed_writes;			/**< write calls that failed, nothing reached the panel ram */
+    uint32_t recoveries;			/**< calls to recover */
+    uint64_t delay_us;				/**< retry delays requested by the driver */
+} ssd1306_mock_t;
+
+/**
+*	@brief mock transport, its context is a ssd1306_mock_t
+*/
+extern const ssd1306_transport_t ssd1306_mock_transport;
+
+/**
+	@brief reset the emulated panel to its power on state and clear the counters
+
+	@param[in] m : emulated panel
+	@param[in] ns_per_byte : simulated bus time per byte (25000 for i2c at 400 kHz), 0 to run at full speed
+*/
+void ssd1306_mock_init(ssd1306_mock_t *m, uint32_t ns_per_byte);
+
+/**
+	@brief advance continuous scrolling by one step, as the panel does every interval frames
+
+	@param[in] m : emulated panel
+*/
+void ssd1306_mock_scroll_step(ssd1306_mock_t *m);
+
+/**
+	@brief compare the panel ram with the buffer of a display
+
+	page n of the buffer is compared with ram page (n+start_line/8)%8, as ssd1306_show sends it
+
+	@param[in] m : emulated panel
+	@param[in] p : display driven through m
+
+	@return bool.
+	@retval true if the panel shows the buffer
+*/
+bool ssd1306_mock_matches(const ssd1306_mock_t *m, const ssd1306_t *p);
+
+/**
+	@brief write what the panel shows as a binary pbm image, for golden image comparisons
+
+	the image follows the start line and the vertical scroll area
+
+	@param[in] m : emulated panel
+	@param[in] width : width of display
+	@param[in] height : height of display
+	@param[in] f : output file
+
+	@return bool.
+	@retval true for Success
+	@retval false if writing failed
+*/
+bool ssd1306_mock_write_pbm(const ssd1306_mock_t *m, uint32_t width, uint32_t height, FILE *f);
+
+#endif
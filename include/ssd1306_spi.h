@@ -0,0 +1,41 @@
+/**
+* @file ssd1306_spi.h
+*
+* 4-wire spi transport for ssd1306 displays (Raspberry Pi Pico)
+*/
+
+#ifndef _inc_ssd1306_spi
+#define _inc_ssd1306_spi
+#include <pico/stdlib.h>
+#include <hardware/spi.h>
+
+#include "ssd1306.h"
+
+/**
+*	@brief spi connection, pins must already be configured (cs and dc as outputs, cs high)
+*/
+typedef struct {
+    spi_inst_t *spi;	/**< spi connection instance */
+    uint cs;			/**< chip select pin (active low) */
+    uint dc;			/**< data/command pin (low for commands) */
+    uint dma;			/**< dma channel of ram writes (ssd1306_spi_enable_dma) */
+    bool dma_enabled;	/**< ram writes run on dma, the driver waits for them before the next command */
+} ssd1306_spi_t;
+
+/**
+*	@brief spi transport, its context is a ssd1306_spi_t
+*/
+extern const ssd1306_transport_t ssd1306_spi_transport;
+
+/**
+	@brief send ram writes by dma, so ssd1306_show_paged draws the next page while one is sent
+
+	@param[in] s : spi connection
+
+	@return bool.
+	@retval true for Success
+	@retval false if no dma channel is free
+*/
+bool ssd1306_spi_enable_dma(ssd1306_spi_t *s);
+
+#endif
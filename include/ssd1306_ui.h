@@ -0,0 +1,220 @@
+/**
+* @file ssd1306_ui.h
+*
+* retained widgets on top of the ssd1306 driver
+*
+* widgets keep their state (text, position, visibility) and are laid out in a tree of groups.
+* changing a widget only records the rectangles whose pixels change: for text, the char cells
+* that differ. ssd1306_ui_render then clears those rectangles and redraws the visible widgets
+* that touch them, in one pass, so a frame costs what changed instead of the whole screen.
+* the ui owns the pixels of its widgets: anything else drawn over them is lost on the next
+* render that touches them
+*/
+
+#ifndef _inc_ssd1306_ui
+#define _inc_ssd1306_ui
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "ssd1306.h"
+
+/**
+*	@brief longest text of a text widget
+*/
+#define SSD1306_UI_TEXT 21
+
+/**
+*	@brief changed rectangles kept until the render, more are merged into the closest one
+*/
+#define SSD1306_UI_RECTS 8
+
+/**
+*	@brief kinds of widget
+*/
+typedef enum {
+    SSD1306_UI_GROUP,	/**< holds other widgets, hiding it hides them */
+    SSD1306_UI_LABEL,	/**< text with the advance of its font */
+    SSD1306_UI_GRID_ROW,	/**< one char per cell, cells a fixed pitch apart */
+    SSD1306_UI_FIELD,	/**< masked text: one mask char per char of the text */
+    SSD1306_UI_CURSOR,	/**< arrow pointing right, at one of evenly spaced rows */
+    SSD1306_UI_ASSET	/**< compressed image, see ssd1306_draw_asset */
+} ssd1306_ui_kind_t;
+
+/**
+*	@brief rectangle of display pixels, both corners included
+*/
+typedef struct {
+    uint8_t x0, y0, x1, y1;
+} ssd1306_ui_rect_t;
+
+struct ssd1306_ui;
+
+/**
+*	@brief a widget, see the ssd1306_ui_add functions
+*/
+typedef struct ssd1306_widget {
+    ssd1306_ui_kind_t kind;		/**< kind of widget */
+    struct ssd1306_ui *ui;		/**< ui the widget belongs to */
+    struct ssd1306_widget *parent;	/**< group holding the widget, NULL for the root */
+    struct ssd1306_widget *child;	/**< first widget of a group */
+    struct ssd1306_widget *next;	/**< next widget of the same group */
+    uint8_t x;					/**< left edge */
+    uint8_t y;					/**< top edge (of the first row for a cursor) */
+    bool visible;				/**< drawn if it and all its groups are visible */
+    const uint8_t *font;		/**< font of text widgets */
+    uint8_t scale;				/**< scale of text widgets */
+    uint8_t pitch;				/**< distance between chars of text widgets, rows of a cursor */
+    char mask;					/**< char shown for each char of a field */
+    uint8_t index;				/**< row of a cursor */
+    char text[SSD1306_UI_TEXT+1];	/**< text of text widgets */
+    const uint8_t *asset;		/**< image of an asset widget */
+    size_t asset_size;			/**< size of the image */
+} ssd1306_widget_t;
+
+/**
+*	@brief a widget tree drawn on one display
+*/
+typedef struct ssd1306_ui {
+    ssd1306_t *disp;			/**< display the widgets are drawn on */
+    ssd1306_widget_t root;		/**< group holding the top level widgets */
+    ssd1306_ui_rect_t rects[SSD1306_UI_RECTS];	/**< rectangles to redraw */
+    uint8_t rect_count;			/**< number of rectangles to redraw */
+    uint32_t renders;			/**< renders that redrew something */
+    uint32_t widgets_drawn;		/**< widgets (or text cells) drawn by all renders */
+} ssd1306_ui_t;
+
+/**
+	@brief initialize a ui, the whole display is redrawn by the first render
+
+	@param[in] ui : ui to initialize
+	@param[in] p : initialized instance of display
+*/
+void ssd1306_ui_init(ssd1306_ui_t *ui, ssd1306_t *p);
+
+/**
+	@brief add a group
+
+	@param[in] ui : ui
+	@param[in] w : widget storage, must outlive the ui
+	@param[in] parent : group to add to, NULL for the top level
+*/
+void ssd1306_ui_add_group(ssd1306_ui_t *ui, ssd1306_widget_t *w, ssd1306_widget_t *parent);
+
+/**
+	@brief add a label
+
+	@param[in] ui : ui
+	@param[in] w : widget storage, must outlive the ui
+	@param[in] parent : group to add to, NULL for the top level
+	@param[in] x : left edge
+	@param[in] y : top edge
+	@param[in] font : font of the text
+	@param[in] scale : scale of the text
+	@param[in] text : initial text
+*/
+void ssd1306_ui_add_label(ssd1306_ui_t *ui, ssd1306_widget_t *w, ssd1306_widget_t *parent, uint8_t x, uint8_t y, const uint8_t *font, uint8_t scale, const char *text);
+
+/**
+	@brief add a grid row, one char per cell
+
+	@param[in] ui : ui
+	@param[in] w : widget storage, must outlive the ui
+	@param[in] parent : group to add to, NULL for the top level
+	@param[in] x : left edge of the first cell
+	@param[in] y : top edge
+	@param[in] font : font of the cells
+	@param[in] scale : scale of the cells
+	@param[in] pitch : distance between the left edges of two cells
+	@param[in] cells : initial chars, one per cell
+*/
+void ssd1306_ui_add_grid_row(ssd1306_ui_t *ui, ssd1306_widget_t *w, ssd1306_widget_t *parent, uint8_t x, uint8_t y, const uint8_t *font, uint8_t scale, uint8_t pitch, const char *cells);
+
+/**
+	@brief add a masked text field, empty
+
+	@param[in] ui : ui
+	@param[in] w : widget storage, must outlive the ui
+	@param[in] parent : group to add to, NULL for the top level
+	@param[in] x : left edge
+	@param[in] y : top edge
+	@param[in] font : font of the mask
+	@param[in] scale : scale of the mask
+	@param[in] mask : char shown for each char of the text
+*/
+void ssd1306_ui_add_field(ssd1306_ui_t *ui, ssd1306_widget_t *w, ssd1306_widget_t *parent, uint8_t x, uint8_t y, const uint8_t *font, uint8_t scale, char mask);
+
+/**
+	@brief add a cursor, a 4x5 arrow pointing right
+
+	@param[in] ui : ui
+	@param[in] w : widget storage, must outlive the ui
+	@param[in] parent : group to add to, NULL for the top level
+	@param[in] x : left edge
+	@param[in] y : top edge at row 0
+	@param[in] pitch : distance between two rows
+*/
+void ssd1306_ui_add_cursor(ssd1306_ui_t *ui, ssd1306_widget_t *w, ssd1306_widget_t *parent, uint8_t x, uint8_t y, uint8_t pitch);
+
+/**
+	@brief add an image
+
+	@param[in] ui : ui
+	@param[in] w : widget storage, must outlive the ui
+	@param[in] parent : group to add to, NULL for the top level
+	@param[in] x : left edge
+	@param[in] y : top edge
+	@param[in] data : asset, NULL for none
+	@param[in] size : size of asset in bytes
+*/
+void ssd1306_ui_add_asset(ssd1306_ui_t *ui, ssd1306_widget_t *w, ssd1306_widget_t *parent, uint8_t x, uint8_t y, const uint8_t *data, size_t size);
+
+/**
+	@brief show or hide a widget (and all widgets of a group)
+
+	@param[in] w : widget
+	@param[in] visible : whether to show it
+*/
+void ssd1306_ui_set_visible(ssd1306_widget_t *w, bool visible);
+
+/**
+	@brief change the text of a label, the cells of a grid row or the text behind a field
+
+	only the char cells that look different are redrawn
+
+	@param[in] w : text widget
+	@param[in] text : new text, cut at SSD1306_UI_TEXT chars
+*/
+void ssd1306_ui_set_text(ssd1306_widget_t *w, const char *text);
+
+/**
+	@brief move a cursor to a row
+
+	@param[in] w : cursor
+	@param[in] index : row
+*/
+void ssd1306_ui_set_index(ssd1306_widget_t *w, uint8_t index);
+
+/**
+	@brief change the image of an asset widget
+
+	@param[in] w : asset widget
+	@param[in] data : asset, NULL for none
+	@param[in] size : size of asset in bytes
+*/
+void ssd1306_ui_set_asset(ssd1306_widget_t *w, const uint8_t *data, size_t size);
+
+/**
+	@brief redraw what changed since the last render into the display buffer
+
+	the buffer still has to be sent (ssd1306_show, ssd1306_async_show)
+
+	@param[in] ui : ui
+
+	@return bool.
+	@retval true if something was redrawn
+	@retval false if nothing changed
+*/
+bool ssd1306_ui_render(ssd1306_ui_t *ui);
+
+#endif
@@ -2,9 +2,13 @@
 #include "pico/stdlib.h"
 #include "hardware/timer.h"
 #include "ssd1306.h"
+#include "ssd1306_i2c.h"
+#include "ssd1306_async.h"
+#include "ssd1306_mirror.h"
+#include "ssd1306_ui.h"
+#include "keypad.h"
 #include "hardware/i2c.h"
 #include "hardware/adc.h"
-#include "pico/rand.h"
 #include "hardware/pwm.h"
 #include "hardware/clocks.h"
 #include <string.h>
@@ -27,11 +31,26 @@
 #define PWM_DIVIDER 16.0
 #define PWM_LED_LEVEL 100
 
-#define NUM_LINES 4
-#define NUMBERS_PER_LINE 4
-#define PIN_LENGTH 6
 #define DEBOUNCE_TIME_MS 200
-#define TOTAL_CHARS 16
+#define DISPLAY_WIDTH 128
+#define DISPLAY_HEIGHT 64
+#define DISPLAY_FLUSH_PRIORITY 3
+#ifndef DISPLAY_FRAME_DEADLINE_MS
+#define DISPLAY_FRAME_DEADLINE_MS 0  // espera por mais comandos do quadro; 0 junta só os que já estão na fila
+#endif
+#ifndef DISPLAY_STATS_INTERVAL
+#define DISPLAY_STATS_INTERVAL 0  // quadros entre relatórios; o printf bloqueia a task_display, só para depuração
+#endif
+#ifndef DISPLAY_MIRROR
+#define DISPLAY_MIRROR 0
+#endif
+#define DISPLAY_MIRROR_PRIORITY 1
+#define I2C_SDA 14
+#define I2C_SCL 15
+#define I2C_BAUDRATE 400000
+#ifndef AUTH_LATENCY_STATS
+#define AUTH_LATENCY_STATS 0  // imprime na task_auth, só para depuração; a medição fica no benchmark do host
+#endif
 
 typedef enum {
     EVENTO_NAVEGACAO,
@@ -44,54 +63,75 @@ typedef struct {
 } InputEvent_t;
 
 typedef struct {
-    uint8_t etapa;
+    uint8_t sessao;  // sessoes[sessao] a gerar
 } RandomizerRequest_t;
 
 typedef struct {
-    uint8_t etapa;
-    char matriz[NUM_LINES][NUMBERS_PER_LINE];
+    uint8_t sessao;  // sessoes[sessao] pronta
 } RandomizerResponse_t;
 
-typedef enum {
-    DISP_ATUALIZAR_MATRIZ,
-    DISP_ATUALIZAR_SELECAO,
-    DISP_ATUALIZAR_SENHA,
-    DISP_MENSAGEM
-} DisplayCommandType_t;
+typedef struct {
+    bool sucesso;
+} AuthResult_t;
 
+/**
+ * @brief Comandos de display juntados em um quadro: de cada tipo, só o último recebido.
+ */
 typedef struct {
-    DisplayCommandType_t tipo;
-    union {
-        char matriz[NUM_LINES][NUMBERS_PER_LINE];
-        uint8_t linha;
-        char senha[PIN_LENGTH+1];
-        char mensagem[30];
-    } data;
-} DisplayCommand_t;
+    DisplayCommand_t *ultimo[DISP_NUM_TIPOS];  // NULL se o tipo não veio
+    DisplayCommandType_t ultima_tela;  // DISP_ATUALIZAR_MATRIZ ou DISP_MENSAGEM, o que chegou por último
+    uint32_t recebidos;
+} QuadroDisplay_t;
 
+/**
+ * @brief Contadores da task de display; comandos / quadros é a média de comandos por envio.
+ */
 typedef struct {
-    bool sucesso;
-} AuthResult_t;
+    uint32_t comandos;        // comandos recebidos
+    uint32_t substituidos;    // comandos trocados por um posterior do mesmo tipo no mesmo quadro
+    uint32_t quadros;         // quadros enviados ao display
+    uint32_t max_por_quadro;  // maior número de comandos em um quadro
+} EstatisticasDisplay_t;
+
+/**
+ * @brief Tempo entre a seleção de um dígito e o envio da matriz da próxima etapa.
+ */
+typedef struct {
+    uint32_t trocas;
+    uint64_t total_us;
+    uint32_t max_us;
+} LatenciaTeclado_t;
 
 QueueHandle_t xQueueInput;
 QueueHandle_t xQueueRandomizerRequest;
 QueueHandle_t xQueueRandomizerResponse;
-QueueHandle_t xQueueDisplay;
 QueueHandle_t xQueueAuthResult;
 SemaphoreHandle_t xSemaphoreButton;
-SemaphoreHandle_t xMutexMatriz;
 
-static char matrizes_digitos[PIN_LENGTH][NUM_LINES][NUMBERS_PER_LINE];
+static uint8_t disp_buffer[SSD1306_BUFFER_SIZE(DISPLAY_WIDTH, DISPLAY_HEIGHT)];
+static uint8_t disp_front[SSD1306_BUFFER_SIZE(DISPLAY_WIDTH, DISPLAY_HEIGHT)];
 ssd1306_t disp;
+static ssd1306_i2c_t disp_i2c;
+ssd1306_async_t disp_async;
+#if DISPLAY_MIRROR
+static ssd1306_mirror_t disp_mirror;
+#endif
 uint8_t global_linha_selecionada = 0;
 
+static ssd1306_ui_t ui;
+static EstatisticasDisplay_t estatisticas_display;
+#if AUTH_LATENCY_STATS
+static LatenciaTeclado_t latencia_teclado;
+#endif
+
 void inicializar_display(void);
 void inicializar_joystick(void);
 void inicializar_pwm_led(uint led_pin);
 void inicializar_pwm_buzzer(uint pin);
 void emitir_beep(uint pin, uint frequencia, uint duracao_ms);
-void mostrar_selecao(ssd1306_t *disp, uint8_t linha);
-void limpar_area_selecao(ssd1306_t *disp);
+void mostrar_etapa(const char matriz[NUM_LINES][NUMBERS_PER_LINE], uint8_t linha);
+void registrar_comando_display(QuadroDisplay_t *quadro, DisplayCommand_t *cmd);
+void aplicar_quadro_display(QuadroDisplay_t *quadro);
 
 /**
  * @brief Rotina de serviço de interrupção do botão.
@@ -159,183 +199,147 @@ void task_input(void *pvParameters) {
 
 /**
  * @brief Tarefa responsável por embaralhar e gerar matrizes do teclado.
+ *
+ * Cada pedido preenche as matrizes de todas as etapas de uma sessão, antes de a sessão
+ * começar, e a task_auth só troca de matriz ao avançar de etapa.
+ *
  * @param pvParameters Ponteiro passado na criação da tarefa (não utilizado).
  */
 void task_randomizer(void *pvParameters) {
     RandomizerRequest_t request;
-    char matriz_flat[TOTAL_CHARS];
     
     while (1) {
         if (xQueueReceive(xQueueRandomizerRequest, &request, portMAX_DELAY)) {
-            const char chars[] = {'0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F'};
-            memcpy(matriz_flat, chars, TOTAL_CHARS);
-            
-            for (size_t i = 0; i < TOTAL_CHARS - 1; i++) {
-                size_t j = i + (get_rand_32() % (TOTAL_CHARS - i));
-                char t = matriz_flat[j];
-                matriz_flat[j] = matriz_flat[i];
-                matriz_flat[i] = t;
-            }
-            
-            RandomizerResponse_t response;
-            response.etapa = request.etapa;
-            
-            int index = 0;
-            for (int i = 0; i < NUM_LINES; i++) {
-                for (int j = 0; j < NUMBERS_PER_LINE; j++) {
-                    char novo_caractere = matriz_flat[index++];
-                    bool duplicata = false;
-                    
-                    for (int k = 0; k < i; k++) {
-                        for (int l = 0; l < NUMBERS_PER_LINE; l++) {
-                            if (response.matriz[k][l] == novo_caractere) {
-                                duplicata = true;
-                                break;
-                            }
-                        }
-                        if (duplicata) break;
-                    }
-                    
-                    int tentativas = 0;
-                    while (duplicata && tentativas < 10) {
-                        if (index >= TOTAL_CHARS) {
-                            index = 0;
-                            for (size_t idx = 0; idx < TOTAL_CHARS - 1; idx++) {
-                                size_t jdx = idx + (get_rand_32() % (TOTAL_CHARS - idx));
-                                char t = matriz_flat[jdx];
-                                matriz_flat[jdx] = matriz_flat[idx];
-                                matriz_flat[idx] = t;
-                            }
-                        }
-                        novo_caractere = matriz_flat[index++];
-                        duplicata = false;
-                        for (int k = 0; k < i; k++) {
-                            for (int l = 0; l < NUMBERS_PER_LINE; l++) {
-                                if (response.matriz[k][l] == novo_caractere) {
-                                    duplicata = true;
-                                    break;
-                                }
-                            }
-                            if (duplicata) break;
-                        }
-                        tentativas++;
-                    }
-                    response.matriz[i][j] = novo_caractere;
-                }
-            }
-            
-            xSemaphoreTake(xMutexMatriz, portMAX_DELAY);
-            memcpy(matrizes_digitos[request.etapa], response.matriz, sizeof(response.matriz));
-            xSemaphoreGive(xMutexMatriz);
+            gerar_sessao(request.sessao);
             
+            RandomizerResponse_t response = { .sessao = request.sessao };
             xQueueSend(xQueueRandomizerResponse, &response, portMAX_DELAY);
         }
     }
 }
 
 /**
- * @brief Limpa a área de seleção do teclado no display.
- * @param disp Ponteiro para a instância do display.
+ * @brief Guarda um comando no quadro, liberando o anterior do mesmo tipo.
+ * @param quadro Comandos do quadro em montagem.
+ * @param cmd Comando recebido.
  */
-void limpar_area_selecao(ssd1306_t *disp) {
-    ssd1306_clear_square(disp, 0, 0, 15, 64);
+void registrar_comando_display(QuadroDisplay_t *quadro, DisplayCommand_t *cmd) {
+    if (cmd->tipo >= DISP_NUM_TIPOS) {
+        liberar_comando_display(cmd);
+        return;
+    }
+
+    estatisticas_display.comandos++;
+    if (quadro->ultimo[cmd->tipo]) {
+        liberar_comando_display(quadro->ultimo[cmd->tipo]);
+        estatisticas_display.substituidos++;
+    }
+    quadro->ultimo[cmd->tipo] = cmd;
+    quadro->recebidos++;
+    if (cmd->tipo == DISP_ATUALIZAR_MATRIZ || cmd->tipo == DISP_MENSAGEM) {
+        quadro->ultima_tela = cmd->tipo;
+    }
 }
 
 /**
- * @brief Desenha o indicador de seleção em uma linha do display.
- * @param disp Ponteiro para a instância do display.
- * @param linha Índice da linha a destacar (0–3).
+ * @brief Aplica os comandos do quadro com o mesmo resultado de aplicá-los na ordem recebida e os libera.
+ * @param quadro Comandos do quadro.
  */
-void mostrar_selecao(ssd1306_t *disp, uint8_t linha) {
-    uint32_t x = 10;
-    uint32_t y;
-    
-    switch (linha) {
-        case 0: y = 5; break;
-        case 1: y = 20; break;
-        case 2: y = 35; break;
-        case 3: y = 50; break;
-        default: return;
+void aplicar_quadro_display(QuadroDisplay_t *quadro) {
+    // cada tipo só muda o próprio estado, exceto as telas, que trocam a visibilidade:
+    // a que chegou por último é aplicada por último
+    const DisplayCommandType_t ordem[] = {
+        quadro->ultima_tela == DISP_MENSAGEM ? DISP_ATUALIZAR_MATRIZ : DISP_MENSAGEM,
+        DISP_ATUALIZAR_SELECAO,
+        DISP_ATUALIZAR_SENHA,
+        quadro->ultima_tela
+    };
+
+    for (size_t i = 0; i < sizeof(ordem) / sizeof(ordem[0]); i++) {
+        DisplayCommand_t *cmd = quadro->ultimo[ordem[i]];
+        if (cmd) {
+            aplicar_comando_display(cmd);
+            liberar_comando_display(cmd);
+        }
     }
-    
-    ssd1306_draw_square(disp, x, y, 2, 5);
-    ssd1306_draw_square(disp, x + 1, y + 1, 2, 3);
-    ssd1306_draw_square(disp, x + 2, y + 2, 2, 1);
 }
 
 /**
  * @brief Tarefa responsável por atualizar o display OLED.
+ *
+ * Espera um comando e junta os que chegarem até DISPLAY_FRAME_DEADLINE_MS depois dele. Com o
+ * prazo em 0 (padrão) junta só os que já estiverem na fila: a task_auth tem prioridade maior e
+ * enfileira SENHA, MATRIZ e SELECAO antes desta task voltar a rodar. Os comandos do quadro são
+ * aplicados juntos e o display é enviado uma vez só.
+ *
  * @param pvParameters Ponteiro passado na criação da tarefa (não utilizado).
  */
 void task_display(void *pvParameters) {
     inicializar_display();
-    uint8_t current_line = 0;
-    uint8_t last_line = 0xFF;
-    char senha_display[PIN_LENGTH+1] = {0};
-    bool matriz_visivel = true;
+    montar_interface(&ui, &disp);
     
     while (1) {
-        DisplayCommand_t cmd;
-        if (xQueueReceive(xQueueDisplay, &cmd, portMAX_DELAY)) {
-            switch (cmd.tipo) {
-                case DISP_ATUALIZAR_MATRIZ: {
-                    matriz_visivel = true;
-                    char buffer[20];
-                    ssd1306_clear(&disp);
-                    
-                    for (int i = 0; i < NUM_LINES; i++) {
-                        sprintf(buffer, "%c %c %c %c",
-                                cmd.data.matriz[i][0], cmd.data.matriz[i][1],
-                                cmd.data.matriz[i][2], cmd.data.matriz[i][3]);
-                        ssd1306_draw_string(&disp, 25, 5 + 15*i, 1, buffer);
-                    }
-                    
-                    if (senha_display[0] != '\0') {
-                        ssd1306_draw_string(&disp, 80, 27, 1, senha_display);
-                    }
-                    
-                    if (last_line != current_line) {
-                        limpar_area_selecao(&disp);
-                        mostrar_selecao(&disp, current_line);
-                        last_line = current_line;
-                    } else {
-                        mostrar_selecao(&disp, current_line);
-                    }
-                    ssd1306_show(&disp);
-                    break;
-                }
-                case DISP_ATUALIZAR_SELECAO:
-                    if (matriz_visivel) {
-                        limpar_area_selecao(&disp);
-                        current_line = cmd.data.linha;
-                        mostrar_selecao(&disp, current_line);
-                        last_line = current_line;
-                        ssd1306_show(&disp);
-                    }
-                    break;
-                case DISP_ATUALIZAR_SENHA:
-                    if (matriz_visivel) {
-                        strncpy(senha_display, cmd.data.senha, sizeof(senha_display));
-                        ssd1306_clear_square(&disp, 80, 27, 48, 8);
-                        ssd1306_draw_string(&disp, 80, 27, 1, senha_display);
-                        ssd1306_show(&disp);
-                    } else {
-                        strncpy(senha_display, cmd.data.senha, sizeof(senha_display));
-                    }
-                    break;
-                case DISP_MENSAGEM:
-                    matriz_visivel = false;
-                    ssd1306_clear(&disp);
-                    ssd1306_draw_string(&disp, 15, 30, 1, cmd.data.mensagem);
-                    ssd1306_show(&disp);
-                    break;
+        DisplayCommand_t *cmd = receber_comando_display(portMAX_DELAY);
+        if (!cmd) continue;
+
+        QuadroDisplay_t quadro = { .ultima_tela = DISP_ATUALIZAR_MATRIZ };
+        const TickType_t inicio = xTaskGetTickCount();
+        const TickType_t prazo = pdMS_TO_TICKS(DISPLAY_FRAME_DEADLINE_MS);
+        TickType_t espera;
+        do {
+            registrar_comando_display(&quadro, cmd);
+            const TickType_t passado = xTaskGetTickCount() - inicio;
+            espera = passado < prazo ? prazo - passado : 0;
+        } while ((cmd = receber_comando_display(espera)));
+
+        aplicar_quadro_display(&quadro);
+
+        // apaga e redesenha só os retângulos que mudaram
+        if (ssd1306_ui_render(&ui)) {
+            ssd1306_async_show(&disp_async);
+            estatisticas_display.quadros++;
+            if (quadro.recebidos > estatisticas_display.max_por_quadro) {
+                estatisticas_display.max_por_quadro = quadro.recebidos;
+            }
+#if DISPLAY_STATS_INTERVAL
+            if (estatisticas_display.quadros % DISPLAY_STATS_INTERVAL == 0) {
+                const EstatisticasDisplay_t *e = &estatisticas_display;
+                const unsigned long centesimos = 100ul * e->comandos / e->quadros;
+                printf("display: %lu comandos em %lu quadros (%lu.%02lu por quadro, max %lu), %lu substituidos\n",
+                       (unsigned long)e->comandos, (unsigned long)e->quadros, centesimos / 100, centesimos % 100,
+                       (unsigned long)e->max_por_quadro, (unsigned long)e->substituidos);
             }
+#endif
         }
     }
 }
 
+/**
+ * @brief Envia ao display a matriz de uma etapa e a linha selecionada.
+ * @param matriz Matriz da etapa.
+ * @param linha Linha selecionada.
+ */
+void mostrar_etapa(const char matriz[NUM_LINES][NUMBERS_PER_LINE], uint8_t linha) {
+    DisplayCommand_t *cmd_matriz = reservar_comando_display(DISP_ATUALIZAR_MATRIZ);
+    if (cmd_matriz) {
+        memcpy(cmd_matriz->data.matriz, matriz, sizeof(cmd_matriz->data.matriz));
+        enviar_comando_display(cmd_matriz);
+    }
+    
+    DisplayCommand_t *cmd_sel = reservar_comando_display(DISP_ATUALIZAR_SELECAO);
+    if (cmd_sel) {
+        cmd_sel->data.linha = linha;
+        enviar_comando_display(cmd_sel);
+    }
+}
+
 /**
  * @brief Tarefa que gerencia o fluxo de autenticação e validação de senha.
+ *
+ * As matrizes da sessão atual e da próxima são geradas com antecedência pela task_randomizer,
+ * então avançar de etapa só troca a matriz mostrada. Com AUTH_LATENCY_STATS, mede o tempo
+ * entre receber a seleção e enviar a nova matriz ao display.
+ *
  * @param pvParameters Ponteiro passado na criação da tarefa (não utilizado).
  */
 void task_auth(void *pvParameters) {
@@ -343,51 +347,54 @@ void task_auth(void *pvParameters) {
     char senha_display[PIN_LENGTH+1] = {0};
     uint8_t linhas_selecionadas[PIN_LENGTH] = {0};
     
-    RandomizerRequest_t request = { .etapa = 0 };
+    // a sessão 0 é usada agora e a 1 é gerada em segundo plano para a próxima
+    RandomizerRequest_t request = { .sessao = 0 };
+    xQueueSend(xQueueRandomizerRequest, &request, 0);
+    request.sessao = 1;
     xQueueSend(xQueueRandomizerRequest, &request, 0);
     
     RandomizerResponse_t response;
-    if (xQueueReceive(xQueueRandomizerResponse, &response, pdMS_TO_TICKS(1000))) {
-        DisplayCommand_t cmd_matriz = { .tipo = DISP_ATUALIZAR_MATRIZ };
-        memcpy(cmd_matriz.data.matriz, response.matriz, sizeof(response.matriz));
-        xQueueSend(xQueueDisplay, &cmd_matriz, 0);
-        
-        DisplayCommand_t cmd_sel = { .tipo = DISP_ATUALIZAR_SELECAO, .data.linha = 0 };
-        xQueueSend(xQueueDisplay, &cmd_sel, 0);
-        global_linha_selecionada = 0;
-    }
+    xQueueReceive(xQueueRandomizerResponse, &response, portMAX_DELAY);
+    uint8_t sessao_atual = response.sessao;
+    mostrar_etapa(sessoes[sessao_atual][0], 0);
+    global_linha_selecionada = 0;
     
     while (1) {
         InputEvent_t evento;
         if (xQueueReceive(xQueueInput, &evento, portMAX_DELAY)) {
             if (evento.tipo == EVENTO_NAVEGACAO) {
                 global_linha_selecionada = evento.linha;
-                DisplayCommand_t cmd = { .tipo = DISP_ATUALIZAR_SELECAO, .data.linha = global_linha_selecionada };
-                xQueueSend(xQueueDisplay, &cmd, 0);
+                DisplayCommand_t *cmd = reservar_comando_display(DISP_ATUALIZAR_SELECAO);
+                if (cmd) {
+                    cmd->data.linha = global_linha_selecionada;
+                    enviar_comando_display(cmd);
+                }
             } else if (evento.tipo == EVENTO_SELECAO) {
                 if (char_count < PIN_LENGTH) {
+#if AUTH_LATENCY_STATS
+                    const uint64_t inicio_us = time_us_64();
+#endif
                     linhas_selecionadas[char_count] = global_linha_selecionada;
                     senha_display[char_count] = '*';
                     senha_display[char_count + 1] = '\0';
                     char_count++;
                     
-                    DisplayCommand_t cmd_senha = { .tipo = DISP_ATUALIZAR_SENHA };
-                    strncpy(cmd_senha.data.senha, senha_display, PIN_LENGTH+1);
-                    xQueueSend(xQueueDisplay, &cmd_senha, 0);
+                    DisplayCommand_t *cmd_senha = reservar_comando_display(DISP_ATUALIZAR_SENHA);
+                    if (cmd_senha) {
+                        strncpy(cmd_senha->data.senha, senha_display, PIN_LENGTH+1);
+                        enviar_comando_display(cmd_senha);
+                    }
                     
                     if (char_count < PIN_LENGTH) {
-                        RandomizerRequest_t req = { .etapa = char_count };
-                        xQueueSend(xQueueRandomizerRequest, &req, 0);
-                        
-                        RandomizerResponse_t resp;
-                        if (xQueueReceive(xQueueRandomizerResponse, &resp, pdMS_TO_TICKS(1000))) {
-                            DisplayCommand_t cmd_matriz = { .tipo = DISP_ATUALIZAR_MATRIZ };
-                            memcpy(cmd_matriz.data.matriz, resp.matriz, sizeof(resp.matriz));
-                            xQueueSend(xQueueDisplay, &cmd_matriz, 0);
-                            
-                            DisplayCommand_t cmd_sel = { .tipo = DISP_ATUALIZAR_SELECAO, .data.linha = global_linha_selecionada };
-                            xQueueSend(xQueueDisplay, &cmd_sel, 0);
+                        mostrar_etapa(sessoes[sessao_atual][char_count], global_linha_selecionada);
+#if AUTH_LATENCY_STATS
+                        const uint32_t latencia_us = time_us_64() - inicio_us;
+                        latencia_teclado.trocas++;
+                        latencia_teclado.total_us += latencia_us;
+                        if (latencia_us > latencia_teclado.max_us) {
+                            latencia_teclado.max_us = latencia_us;
                         }
+#endif
                     } else {
                         bool senha_valida = true;
                         const char senha_correta[PIN_LENGTH] = {'1','2','3','4','5','6'};
@@ -395,14 +402,12 @@ void task_auth(void *pvParameters) {
                         for (int i = 0; i < PIN_LENGTH; i++) {
                             bool digito_valido = false;
                             
-                            xSemaphoreTake(xMutexMatriz, portMAX_DELAY);
                             for (int j = 0; j < NUMBERS_PER_LINE; j++) {
-                                if (matrizes_digitos[i][linhas_selecionadas[i]][j] == senha_correta[i]) {
+                                if (sessoes[sessao_atual][i][linhas_selecionadas[i]][j] == senha_correta[i]) {
                                     digito_valido = true;
                                     break;
                                 }
                             }
-                            xSemaphoreGive(xMutexMatriz);
                             
                             if (!digito_valido) {
                                 senha_valida = false;
@@ -413,10 +418,20 @@ void task_auth(void *pvParameters) {
                         AuthResult_t result = { .sucesso = senha_valida };
                         xQueueSend(xQueueAuthResult, &result, 0);
                         
-                        DisplayCommand_t cmd_msg = { .tipo = DISP_MENSAGEM };
-                        strcpy(cmd_msg.data.mensagem,
-                               senha_valida ? "SENHA CORRETA" : "SENHA INCORRETA");
-                        xQueueSend(xQueueDisplay, &cmd_msg, 0);
+                        DisplayCommand_t *cmd_msg = reservar_comando_display(DISP_MENSAGEM);
+                        if (cmd_msg) {
+                            cmd_msg->data.mensagem = senha_valida ? MENSAGEM_SENHA_CORRETA : MENSAGEM_SENHA_INCORRETA;
+                            enviar_comando_display(cmd_msg);
+                        }
+                        
+#if AUTH_LATENCY_STATS
+                        if (latencia_teclado.trocas) {
+                            printf("teclado: %lu trocas de matriz, media %lu us, max %lu us\n",
+                                   (unsigned long)latencia_teclado.trocas,
+                                   (unsigned long)(latencia_teclado.total_us / latencia_teclado.trocas),
+                                   (unsigned long)latencia_teclado.max_us);
+                        }
+#endif
                         
                         vTaskDelay(pdMS_TO_TICKS(2000));
                         
@@ -425,23 +440,19 @@ void task_auth(void *pvParameters) {
                         memset(senha_display, 0, sizeof(senha_display));
                         memset(linhas_selecionadas, 0, sizeof(linhas_selecionadas));
                         
-                        RandomizerRequest_t req = { .etapa = 0 };
-                        xQueueSend(xQueueRandomizerRequest, &req, 0);
+                        // a próxima sessão foi gerada durante esta, a resposta normalmente já chegou;
+                        // a que acabou é gerada de novo para depois dela
+                        request.sessao = sessao_atual;
+                        xQueueReceive(xQueueRandomizerResponse, &response, portMAX_DELAY);
+                        sessao_atual = response.sessao;
+                        xQueueSend(xQueueRandomizerRequest, &request, 0);
+                        mostrar_etapa(sessoes[sessao_atual][0], 0);
                         
-                        RandomizerResponse_t resp;
-                        if (xQueueReceive(xQueueRandomizerResponse, &resp, pdMS_TO_TICKS(1000))) {
-                            DisplayCommand_t cmd_matriz = { .tipo = DISP_ATUALIZAR_MATRIZ };
-                            memcpy(cmd_matriz.data.matriz, resp.matriz, sizeof(resp.matriz));
-                            xQueueSend(xQueueDisplay, &cmd_matriz, 0);
-                            
-                            DisplayCommand_t cmd_sel = { .tipo = DISP_ATUALIZAR_SELECAO, .data.linha = 0 };
-                            xQueueSend(xQueueDisplay, &cmd_sel, 0);
-                            global_linha_selecionada = 0;
+                        DisplayCommand_t *cmd_clear = reservar_comando_display(DISP_ATUALIZAR_SENHA);
+                        if (cmd_clear) {
+                            strncpy(cmd_clear->data.senha, "", PIN_LENGTH+1);
+                            enviar_comando_display(cmd_clear);
                         }
-                        
-                        DisplayCommand_t cmd_clear = { .tipo = DISP_ATUALIZAR_SENHA };
-                        strncpy(cmd_clear.data.senha, "", PIN_LENGTH+1);
-                        xQueueSend(xQueueDisplay, &cmd_clear, 0);
                     }
                 }
             }
@@ -537,16 +548,22 @@ void inicializar_pwm_buzzer(uint pin) {
  * @brief Inicializa o display OLED via I2C.
  */
 void inicializar_display(void) {
-    i2c_init(i2c1, 400000);
-    gpio_set_function(14, GPIO_FUNC_I2C);
-    gpio_set_function(15, GPIO_FUNC_I2C);
-    gpio_pull_up(14);
-    gpio_pull_up(15);
+    i2c_init(i2c1, I2C_BAUDRATE);
+    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
+    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
+    gpio_pull_up(I2C_SDA);
+    gpio_pull_up(I2C_SCL);
     
     disp.external_vcc = false;
-    ssd1306_init(&disp, 128, 64, 0x3C, i2c1);
+    ssd1306_init_i2c_static(&disp, DISPLAY_WIDTH, DISPLAY_HEIGHT, &disp_i2c, 0x3C, i2c1, disp_buffer);
+    ssd1306_i2c_enable_recovery(&disp_i2c, I2C_SDA, I2C_SCL, I2C_BAUDRATE);
     ssd1306_clear(&disp);
     ssd1306_show(&disp);
+    ssd1306_enable_double_buffer_static(&disp, disp_front);
+    ssd1306_async_start(&disp_async, &disp, DISPLAY_FLUSH_PRIORITY);
+#if DISPLAY_MIRROR
+    ssd1306_mirror_start(&disp_mirror, &disp, DISPLAY_MIRROR_PRIORITY);
+#endif
 }
 
 /**
@@ -582,10 +599,9 @@ void init_freertos() {
     xQueueInput = xQueueCreate(10, sizeof(InputEvent_t));
     xQueueRandomizerRequest = xQueueCreate(5, sizeof(RandomizerRequest_t));
     xQueueRandomizerResponse = xQueueCreate(5, sizeof(RandomizerResponse_t));
-    xQueueDisplay = xQueueCreate(10, sizeof(DisplayCommand_t));
+    iniciar_comandos_display();
     xQueueAuthResult = xQueueCreate(3, sizeof(AuthResult_t));
     xSemaphoreButton = xSemaphoreCreateBinary();
-    xMutexMatriz = xSemaphoreCreateMutex();
     
     gpio_init(BUTTON_R);
     gpio_set_dir(BUTTON_R, GPIO_IN);
@@ -597,15 +613,6 @@ void init_freertos() {
     xTaskCreate(task_display, "Display", 1024, NULL, 4, NULL);
     xTaskCreate(task_auth, "Auth", 1024, NULL, 5, NULL);
     xTaskCreate(task_audio, "Audio", 512, NULL, 3, NULL);
-    
-    const char chars[] = {'0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F'};
-    for (int i = 0; i < PIN_LENGTH; i++) {
-        for (int j = 0; j < NUM_LINES; j++) {
-            for (int k = 0; k < NUMBERS_PER_LINE; k++) {
-                matrizes_digitos[i][j][k] = chars[j * NUMBERS_PER_LINE + k];
-            }
-        }
-    }
 }
 
 /**
@@ -0,0 +1,172 @@
+#include <string.h>
+#include "pico/rand.h"
+#include "FreeRTOS.h"
+#include "queue.h"
+
+#include "keypad.h"
+#include "keypad_assets.h"
+
+char sessoes[2][PIN_LENGTH][NUM_LINES][NUMBERS_PER_LINE];
+
+// comandos do display: a fila leva só o índice, o comando é preenchido e lido no lugar.
+// só a task_auth reserva comandos e só a task_display os libera, então basta uma marca por comando
+static DisplayCommand_t comandos_display[DISPLAY_COMMANDS];
+static bool comando_display_em_uso[DISPLAY_COMMANDS];
+static uint8_t proximo_comando_display;
+static QueueHandle_t fila_comandos_display;
+
+static ssd1306_widget_t tela_matriz, linhas_matriz[NUM_LINES], cursor_selecao, campo_senha;
+static ssd1306_widget_t tela_mensagem, mensagem_resultado;
+
+// mensagens pré-renderizadas em tempo de compilação (assets/keypad.assets)
+static const struct {
+    const uint8_t *asset;
+    size_t tamanho;
+} mensagens[] = {
+    [MENSAGEM_SENHA_CORRETA] = { asset_senha_correta, sizeof(asset_senha_correta) },
+    [MENSAGEM_SENHA_INCORRETA] = { asset_senha_incorreta, sizeof(asset_senha_incorreta) },
+};
+
+void gerar_matriz(char matriz[NUM_LINES][NUMBERS_PER_LINE]) {
+    char matriz_flat[TOTAL_CHARS];
+    const char chars[] = {'0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F'};
+    memcpy(matriz_flat, chars, TOTAL_CHARS);
+    
+    for (size_t i = 0; i < TOTAL_CHARS - 1; i++) {
+        size_t j = i + (get_rand_32() % (TOTAL_CHARS - i));
+        char t = matriz_flat[j];
+        matriz_flat[j] = matriz_flat[i];
+        matriz_flat[i] = t;
+    }
+    
+    int index = 0;
+    for (int i = 0; i < NUM_LINES; i++) {
+        for (int j = 0; j < NUMBERS_PER_LINE; j++) {
+            char novo_caractere = matriz_flat[index++];
+            bool duplicata = false;
+            
+            for (int k = 0; k < i; k++) {
+                for (int l = 0; l < NUMBERS_PER_LINE; l++) {
+                    if (matriz[k][l] == novo_caractere) {
+                        duplicata = true;
+                        break;
+                    }
+                }
+                if (duplicata) break;
+            }
+            
+            int tentativas = 0;
+            while (duplicata && tentativas < 10) {
+                if (index >= TOTAL_CHARS) {
+                    index = 0;
+                    for (size_t idx = 0; idx < TOTAL_CHARS - 1; idx++) {
+                        size_t jdx = idx + (get_rand_32() % (TOTAL_CHARS - idx));
+                        char t = matriz_flat[jdx];
+                        matriz_flat[jdx] = matriz_flat[idx];
+                        matriz_flat[idx] = t;
+                    }
+                }
+                novo_caractere = matriz_flat[index++];
+                duplicata = false;
+                for (int k = 0; k < i; k++) {
+                    for (int l = 0; l < NUMBERS_PER_LINE; l++) {
+                        if (matriz[k][l] == novo_caractere) {
+                            duplicata = true;
+                            break;
+                        }
+                    }
+                    if (duplicata) break;
+                }
+                tentativas++;
+            }
+            matriz[i][j] = novo_caractere;
+        }
+    }
+}
+
+void gerar_sessao(uint8_t sessao) {
+    for (int etapa = 0; etapa < PIN_LENGTH; etapa++) {
+        gerar_matriz(sessoes[sessao][etapa]);
+    }
+}
+
+bool iniciar_comandos_display(void) {
+    fila_comandos_display = xQueueCreate(DISPLAY_COMMANDS, sizeof(uint8_t));
+    return fila_comandos_display != NULL;
+}
+
+DisplayCommand_t *reservar_comando_display(DisplayCommandType_t tipo) {
+    for (int n = 0; n < DISPLAY_COMMANDS; n++) {
+        const uint8_t indice = proximo_comando_display;
+        proximo_comando_display = (proximo_comando_display + 1) % DISPLAY_COMMANDS;
+
+        // acquire: a task_display terminou de ler o comando antes de liberá-lo
+        if (!__atomic_load_n(&comando_display_em_uso[indice], __ATOMIC_ACQUIRE)) {
+            comando_display_em_uso[indice] = true;
+            DisplayCommand_t *cmd = &comandos_display[indice];
+            cmd->tipo = tipo;
+            return cmd;
+        }
+    }
+    return NULL;
+}
+
+void enviar_comando_display(DisplayCommand_t *cmd) {
+    // a fila tem lugar para todos os comandos, o envio não falha
+    const uint8_t indice = cmd - comandos_display;
+    xQueueSend(fila_comandos_display, &indice, 0);
+}
+
+DisplayCommand_t *receber_comando_display(TickType_t espera) {
+    uint8_t indice;
+    if (!xQueueReceive(fila_comandos_display, &indice, espera)) return NULL;
+    return &comandos_display[indice];
+}
+
+void liberar_comando_display(DisplayCommand_t *cmd) {
+    __atomic_store_n(&comando_display_em_uso[cmd - comandos_display], false, __ATOMIC_RELEASE);
+}
+
+void montar_interface(ssd1306_ui_t *ui, ssd1306_t *disp) {
+    ssd1306_ui_init(ui, disp);
+
+    ssd1306_ui_add_group(ui, &tela_matriz, NULL);
+    for (int i = 0; i < NUM_LINES; i++) {
+        ssd1306_ui_add_grid_row(ui, &linhas_matriz[i], &tela_matriz, 25, 5 + 15*i, font_keypad, 1, 12, "");
+    }
+    ssd1306_ui_add_cursor(ui, &cursor_selecao, &tela_matriz, 10, 5, 15);
+    ssd1306_ui_add_field(ui, &campo_senha, &tela_matriz, 80, 27, font_keypad, 1, '*');
+
+    ssd1306_ui_add_group(ui, &tela_mensagem, NULL);
+    ssd1306_ui_add_asset(ui, &mensagem_resultado, &tela_mensagem, 15, 30, NULL, 0);
+    ssd1306_ui_set_visible(&tela_mensagem, false);
+}
+
+void aplicar_comando_display(const DisplayCommand_t *cmd) {
+    switch (cmd->tipo) {
+        case DISP_ATUALIZAR_MATRIZ:
+            ssd1306_ui_set_visible(&tela_mensagem, false);
+            ssd1306_ui_set_visible(&tela_matriz, true);
+            for (int i = 0; i < NUM_LINES; i++) {
+                char celulas[NUMBERS_PER_LINE + 1];
+                memcpy(celulas, cmd->data.matriz[i], NUMBERS_PER_LINE);
+                celulas[NUMBERS_PER_LINE] = '\0';
+                ssd1306_ui_set_text(&linhas_matriz[i], celulas);
+            }
+            break;
+        case DISP_ATUALIZAR_SELECAO:
+            ssd1306_ui_set_index(&cursor_selecao, cmd->data.linha);
+            break;
+        case DISP_ATUALIZAR_SENHA:
+            ssd1306_ui_set_text(&campo_senha, cmd->data.senha);
+            break;
+        case DISP_MENSAGEM:
+            ssd1306_ui_set_visible(&tela_matriz, false);
+            ssd1306_ui_set_asset(&mensagem_resultado, mensagens[cmd->data.mensagem].asset,
+                                 mensagens[cmd->data.mensagem].tamanho);
+            ssd1306_ui_set_visible(&tela_mensagem, true);
+            break;
+        default:
+            break;
+    }
+}
@@ -23,57 +23,98 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
-#include <pico/stdlib.h>
-#include <hardware/i2c.h>
-#include <pico/binary_info.h>
 #include <stdlib.h>
 #include <string.h>
-#include <stdio.h>
 
 #include "ssd1306.h"
+#include "ssd1306_internal.h"
 #include "font.h"
 
-inline static void swap(int32_t *a, int32_t *b) {
-    int32_t *t=a;
-    *a=*b;
-    *b=*t;
+// counts a failed write and prepares the next attempt, false once the attempts are used up
+static bool ssd1306_retry(ssd1306_t *p, int err, uint32_t attempt) {
+    ++p->stats.errors;
+    p->stats.last_error=err;
+    if(attempt>=SSD1306_RETRIES) {
+        ++p->stats.dropped;
+        return false;
+    }
+
+    ++p->stats.retries;
+    if(p->transport->delay)
+        p->transport->delay(p->transport_ctx, SSD1306_RETRY_DELAY_US<<attempt);
+
+    // a slave holding the bus does not go away by waiting: recover it before the last attempt
+    if(attempt+1==SSD1306_RETRIES && p->transport->recover) {
+        ++p->stats.recoveries;
+        if(p->transport->recover(p->transport_ctx)<0)
+            ++p->stats.failed_recoveries;
+    }
+    return true;
 }
 
-inline static void fancy_write(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, char *name) {
-    switch(i2c_write_blocking(i2c, addr, src, len, false)) {
-    case PICO_ERROR_GENERIC:
-        printf("[%s] addr not acknowledged!\n", name);
-        break;
-    case PICO_ERROR_TIMEOUT:
-        printf("[%s] timeout!\n", name);
-        break;
-    default:
-        //printf("[%s] wrote successfully %lu bytes!\n", name, len);
-        break;
+// sends a whole command sequence as one stream
+static bool ssd1306_write_cmds(ssd1306_t *p, const uint8_t *cmds, size_t len) {
+    if(!p->transport) return true; // canvas
+
+    for(uint32_t attempt=0;; ++attempt) {
+        ++p->stats.transactions;
+        const int ret=p->transport->write_cmds(p->transport_ctx, cmds, len);
+        if(ret>=0)
+            return true;
+        if(!ssd1306_retry(p, ret, attempt))
+            return false;
     }
 }
 
-inline static void ssd1306_write(ssd1306_t *p, uint8_t val) {
-    uint8_t d[2]= {0x00, val};
-    fancy_write(p->i2c_i, p->address, d, 2, "ssd1306_write");
+inline static bool ssd1306_write(ssd1306_t *p, uint8_t val) {
+    return ssd1306_write_cmds(p, &val, 1);
 }
 
-bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address, i2c_inst_t *i2c_instance) {
+inline static void ssd1306_span_reset(uint8_t *x0, uint8_t *x1) {
+    memset(x0, 0xFF, SSD1306_MAX_PAGES);
+    memset(x1, 0, SSD1306_MAX_PAGES);
+}
+
+// geometry, buffer and drawing state of displays and canvases
+static bool ssd1306_setup(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t pages, uint8_t *storage) {
     p->width=width;
     p->height=height;
-    p->pages=height/8;
-    p->address=address;
-
-    p->i2c_i=i2c_instance;
-
+    p->pages=pages;
 
     p->bufsize=(p->pages)*(p->width);
-    if((p->buffer=malloc(p->bufsize+1))==NULL) {
-        p->bufsize=0;
-        return false;
+    if(storage==NULL) {
+        if((storage=malloc(p->bufsize+1))==NULL) {
+            p->bufsize=0;
+            return false;
+        }
+        p->owns_buffer=true;
+    } else {
+        p->owns_buffer=false;
     }
 
-    ++(p->buffer);
+    p->buffer=storage+1;
+
+    p->front=NULL;
+    p->owns_front=false;
+    p->text_cache=NULL;
+    p->start_line=0;
+    p->clip_y0=0;
+    p->clip_y1=height-1;
+    p->rop=SSD1306_ROP_SET;
+    p->show_hook=NULL;
+    ssd1306_span_reset(p->front_x0, p->front_x1);
+    p->stats=(ssd1306_stats_t) {0};
+    return true;
+}
+
+bool ssd1306_init_static(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t *storage, const ssd1306_transport_t *transport, void *transport_ctx) {
+    p->transport=transport;
+    p->transport_ctx=transport_ctx;
+    p->owns_transport_ctx=false;
+
+    if(!ssd1306_setup(p, width, height, height/8, storage))
+        return false;
+    ssd1306_invalidate(p); // ram content of the panel is unknown
 
     // from https://github.com/makerportal/rpi-pico-ssd1306
     uint8_t cmds[]= {
@@ -109,14 +150,55 @@ bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address
         0x00,  // horizontal
     };
 
-    for(size_t i=0; i<sizeof(cmds); ++i)
-        ssd1306_write(p, cmds[i]);
+    return ssd1306_write_cmds(p, cmds, sizeof(cmds));
+}
+
+bool ssd1306_canvas_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t *storage) {
+    if(!width || width>255 || !height || height>SSD1306_MAX_PAGES*8)
+        return false;
+
+    p->transport=NULL;
+    p->transport_ctx=NULL;
 
+    if(!ssd1306_setup(p, width, height, (height+7)>>3, storage))
+        return false;
+    memset(p->buffer, 0, p->bufsize);
+    ssd1306_span_reset(p->dirty_x0, p->dirty_x1);
     return true;
 }
 
+bool ssd1306_init_with_transport(ssd1306_t *p, uint16_t width, uint16_t height, const ssd1306_transport_t *transport, void *transport_ctx) {
+    return ssd1306_init_static(p, width, height, NULL, transport, transport_ctx);
+}
+
 inline void ssd1306_deinit(ssd1306_t *p) {
-    free(p->buffer-1);
+    if(p->owns_buffer)
+        free(p->buffer-1);
+    if(p->owns_front)
+        free(p->front-1);
+    if(p->owns_transport_ctx)
+        free(p->transport_ctx);
+}
+
+bool ssd1306_enable_double_buffer_static(ssd1306_t *p, uint8_t *storage) {
+    if(p->front) return true;
+
+    // the front buffer starts out as the frame drawn so far, for the show hook
+    p->front=storage+1;
+    memcpy(p->front, p->buffer, p->bufsize);
+    p->owns_front=false;
+    return true;
+}
+
+bool ssd1306_enable_double_buffer(ssd1306_t *p) {
+    if(p->front) return true;
+
+    uint8_t *storage=malloc(p->bufsize+1);
+    if(storage==NULL) return false;
+
+    ssd1306_enable_double_buffer_static(p, storage);
+    p->owns_front=true;
+    return true;
 }
 
 inline void ssd1306_poweroff(ssd1306_t *p) {
@@ -128,75 +210,440 @@ inline void ssd1306_poweron(ssd1306_t *p) {
 }
 
 inline void ssd1306_contrast(ssd1306_t *p, uint8_t val) {
-    ssd1306_write(p, SET_CONTRAST);
-    ssd1306_write(p, val);
+    uint8_t cmds[]= {SET_CONTRAST, val};
+    ssd1306_write_cmds(p, cmds, sizeof(cmds));
 }
 
 inline void ssd1306_invert(ssd1306_t *p, uint8_t inv) {
     ssd1306_write(p, SET_NORM_INV | (inv & 1));
 }
 
-inline void ssd1306_clear(ssd1306_t *p) {
-    memset(p->buffer, 0, p->bufsize);
+inline void ssd1306_set_rop(ssd1306_t *p, ssd1306_rop_t rop) {
+    p->rop=rop;
+}
+
+void ssd1306_set_start_line(ssd1306_t *p, uint8_t line) {
+    if(ssd1306_write(p, SET_DISP_START_LINE|(line&0x3F)))
+        p->start_line=line&0x3F;
+    else
+        ssd1306_invalidate(p); // the panel kept its start line, send the frame again where it is
+}
+
+// moves the pages of buf and their spans n pages towards page 0 (n<0: away from it)
+static void ssd1306_shift_pages(ssd1306_t *p, uint8_t *buf, uint8_t *x0s, uint8_t *x1s, int32_t n) {
+    const uint32_t shift=n<0?-n:n;
+    const uint32_t keep=shift<p->pages?p->pages-shift:0;
+    const uint32_t from=n>0?shift:0, to=n>0?0:shift;
+    const uint32_t exposed=n>0?keep:0;
+
+    memmove(buf+to*p->width, buf+from*p->width, keep*p->width);
+    memmove(x0s+to, x0s+from, keep);
+    memmove(x1s+to, x1s+from, keep);
+
+    for(uint32_t page=exposed; page<exposed+p->pages-keep; ++page) {
+        x0s[page]=0xFF;
+        x1s[page]=0;
+    }
+}
+
+void ssd1306_scroll_pages(ssd1306_t *p, int32_t pages) {
+    if(!pages) return;
+
+    ssd1306_shift_pages(p, p->buffer, p->dirty_x0, p->dirty_x1, pages);
+    if(p->front)
+        ssd1306_shift_pages(p, p->front, p->front_x0, p->front_x1, pages);
+
+    // the pages scrolled in still hold what scrolled out on the panel
+    for(uint32_t page=0; page<p->pages; ++page) {
+        if(pages>0?page+pages<p->pages:page>=(uint32_t) -pages)
+            continue;
+        memset(p->buffer+page*p->width, 0, p->width);
+        p->dirty_x0[page]=0;
+        p->dirty_x1[page]=p->width-1;
+    }
+
+    ssd1306_set_start_line(p, (p->start_line+pages*8)&0x3F);
+}
+
+void ssd1306_scroll_horizontal(ssd1306_t *p, bool left, uint8_t start_page, uint8_t end_page, uint8_t interval) {
+    // the panel ignores a scroll setup while scrolling
+    uint8_t cmds[]= {SET_SCROLL, SET_HSCROLL+left, 0x00, start_page&0x07, interval&0x07, end_page&0x07, 0x00, 0xFF, SET_SCROLL|0x01};
+    ssd1306_write_cmds(p, cmds, sizeof(cmds));
+}
+
+void ssd1306_scroll_diagonal(ssd1306_t *p, bool left, uint8_t start_page, uint8_t end_page, uint8_t interval, uint8_t vertical_offset) {
+    uint8_t cmds[]= {SET_SCROLL, SET_VHSCROLL+left, 0x00, start_page&0x07, interval&0x07, end_page&0x07, vertical_offset&0x3F, SET_SCROLL|0x01};
+    ssd1306_write_cmds(p, cmds, sizeof(cmds));
+}
+
+inline void ssd1306_scroll_area(ssd1306_t *p, uint8_t top_fixed, uint8_t rows) {
+    uint8_t cmds[]= {SET_SCROLL_AREA, top_fixed&0x3F, rows&0x7F};
+    ssd1306_write_cmds(p, cmds, sizeof(cmds));
+}
+
+void ssd1306_scroll_stop(ssd1306_t *p) {
+    ssd1306_write(p, SET_SCROLL);
+    ssd1306_invalidate(p); // horizontal scrolling moved the ram
+}
+
+void ssd1306_mark_dirty(ssd1306_t *p, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1) {
+    if(x0>=p->width || y0>=p->height || x0>x1 || y0>y1) return;
+
+    if(x1>=p->width)
+        x1=p->width-1;
+    if(y1>=p->height)
+        y1=p->height-1;
+
+    for(uint32_t page=y0>>3; page<=(y1>>3); ++page)
+        ssd1306_dirty_span(p, page, x0, x1);
+}
+
+void ssd1306_invalidate(ssd1306_t *p) {
+    for(uint32_t page=0; page<p->pages; ++page) {
+        p->dirty_x0[page]=0;
+        p->dirty_x1[page]=p->width-1;
+    }
 }
 
 void ssd1306_clear_pixel(ssd1306_t *p, uint32_t x, uint32_t y) {
-    if(x>=p->width || y>=p->height) return;
+    if(x>=p->width || y<p->clip_y0 || y>p->clip_y1) return;
 
-    p->buffer[x+p->width*(y>>3)]&=~(0x1<<(y&0x07));
+    ssd1306_unplot_w(p, p->width, x, y);
+}
+
+// draws pixel (x, y) with the raster op of p, the pixel must be inside the display and the clip rows
+inline static void ssd1306_plot(ssd1306_t *p, uint32_t x, uint32_t y) {
+    ssd1306_plot_w(p, p->width, x, y);
 }
 
 void ssd1306_draw_pixel(ssd1306_t *p, uint32_t x, uint32_t y) {
-    if(x>=p->width || y>=p->height) return;
+    if(x>=p->width || y<p->clip_y0 || y>p->clip_y1) return;
 
-    p->buffer[x+p->width*(y>>3)]|=0x1<<(y&0x07); // y>>3==y/8 && y&0x7==y%8
+    ssd1306_plot(p, x, y);
 }
 
-void ssd1306_draw_line(ssd1306_t *p, int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
-    if(x1>x2) {
-        swap(&x1, &x2);
-        swap(&y1, &y2);
+// combines the bits of mask into columns [x0, x1) of a page and marks the columns that changed
+static void ssd1306_fill_span(ssd1306_t *p, uint32_t page, uint32_t x0, uint32_t x1, uint8_t mask, ssd1306_rop_t rop) {
+    uint8_t *row=p->buffer+page*p->width;
+    uint32_t first=x1, last=0;
+    uint32_t x=x0;
+
+    for(; x<x1 && ((uintptr_t) (row+x)&3); ++x) {
+        const uint8_t b=ssd1306_apply_rop(rop, row[x], mask);
+        if(b!=row[x]) {
+            row[x]=b;
+            if(first==x1)
+                first=x;
+            last=x;
+        }
     }
 
-    if(x1==x2) {
-        if(y1>y2)
-            swap(&y1, &y2);
-        for(int32_t i=y1; i<=y2; ++i)
-            ssd1306_draw_pixel(p, x1, i);
+    const uint32_t mask32=mask*0x01010101u;
+    for(; x+4<=x1; x+=4) {
+        uint32_t w;
+        memcpy(&w, row+x, 4);
+        const uint32_t n=ssd1306_apply_rop(rop, w, mask32);
+        if(n!=w) {
+            memcpy(row+x, &n, 4);
+            // little endian: lowest changed byte is the leftmost column
+            const uint32_t diff=n^w;
+            if(first==x1)
+                first=x+(__builtin_ctz(diff)>>3);
+            last=x+((31-__builtin_clz(diff))>>3);
+        }
+    }
+
+    for(; x<x1; ++x) {
+        const uint8_t b=ssd1306_apply_rop(rop, row[x], mask);
+        if(b!=row[x]) {
+            row[x]=b;
+            if(first==x1)
+                first=x;
+            last=x;
+        }
+    }
+
+    if(first<x1)
+        ssd1306_dirty_span(p, page, first, last);
+}
+
+// fills the area between the corners (x0, y0) and (x1, y1) (inclusive), clipped to the display and the clip rows
+static void ssd1306_fill_area(ssd1306_t *p, int32_t x0, int32_t y0, int32_t x1, int32_t y1, ssd1306_rop_t rop) {
+    if(x0<0)
+        x0=0;
+    if(y0<p->clip_y0)
+        y0=p->clip_y0;
+    if(x1>=p->width)
+        x1=p->width-1;
+    if(y1>p->clip_y1)
+        y1=p->clip_y1;
+    if(x0>x1 || y0>y1) return;
+
+    const uint32_t first_page=y0>>3, last_page=y1>>3;
+
+    for(uint32_t page=first_page; page<=last_page; ++page) {
+        uint8_t mask=0xFF;
+        if(page==first_page)
+            mask&=0xFF<<(y0&7);
+        if(page==last_page)
+            mask&=0xFF>>(7-(y1&7));
+        ssd1306_fill_span(p, page, x0, x1+1, mask, rop);
+    }
+}
+
+void ssd1306_clear(ssd1306_t *p) {
+    if(p->clip_y0 || p->clip_y1<p->height-1) {
+        ssd1306_fill_area(p, 0, p->clip_y0, p->width-1, p->clip_y1, SSD1306_ROP_CLEAR);
         return;
     }
 
-    float m=(float) (y2-y1) / (float) (x2-x1);
+    // only the lit span of each page has to be sent again
+    for(uint32_t page=0; page<p->pages; ++page) {
+        uint8_t *row=p->buffer+page*p->width;
+        uint32_t x0=0, x1=p->width;
+
+        while(x0<x1 && !row[x0])
+            ++x0;
+        while(x1>x0 && !row[x1-1])
+            --x1;
 
-    for(int32_t i=x1; i<=x2; ++i) {
-        float y=m*(float) (i-x1)+(float) y1;
-        ssd1306_draw_pixel(p, i, (uint32_t) y);
+        if(x0<x1)
+            ssd1306_dirty_span(p, page, x0, x1-1);
+    }
+
+    memset(p->buffer, 0, p->bufsize);
+}
+
+static void ssd1306_fill_rect(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height, ssd1306_rop_t rop) {
+    if(x>=p->width || y>=p->height || !width || !height) return;
+
+    if(width>p->width-x)
+        width=p->width-x;
+    if(height>p->height-y)
+        height=p->height-y;
+
+    ssd1306_fill_area(p, x, y, x+width-1, y+height-1, rop);
+}
+
+void ssd1306_draw_line(ssd1306_t *p, int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+    if(y1==y2 || x1==x2) {
+        ssd1306_fill_area(p, x1<x2?x1:x2, y1<y2?y1:y2, x1<x2?x2:x1, y1<y2?y2:y1, p->rop);
+        return;
+    }
+
+    const int32_t dx=x2>x1?x2-x1:x1-x2, sx=x2>x1?1:-1;
+    const int32_t dy=y2>y1?y1-y2:y2-y1, sy=y2>y1?1:-1;
+    int32_t err=dx+dy;
+
+    // clip once: lines completely inside skip the per pixel bounds check
+    const bool inside=(x1|x2)>=0 && x1<p->width && x2<p->width
+                      && y1>=p->clip_y0 && y2>=p->clip_y0 && y1<=p->clip_y1 && y2<=p->clip_y1;
+
+    for(;;) {
+        if(inside)
+            ssd1306_plot(p, x1, y1);
+        else
+            ssd1306_draw_pixel(p, x1, y1);
+
+        if(x1==x2 && y1==y2)
+            break;
+
+        const int32_t e2=2*err;
+        if(e2>=dy) {
+            err+=dy;
+            x1+=sx;
+        }
+        if(e2<=dx) {
+            err+=dx;
+            y1+=sy;
+        }
     }
 }
 
 void ssd1306_clear_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
-    for(uint32_t i=0; i<width; ++i)
-        for(uint32_t j=0; j<height; ++j)
-            ssd1306_clear_pixel(p, x+i, y+j);
+    ssd1306_fill_rect(p, x, y, width, height, SSD1306_ROP_CLEAR);
 }
 
 void ssd1306_draw_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
-    for(uint32_t i=0; i<width; ++i)
-        for(uint32_t j=0; j<height; ++j)
-            ssd1306_draw_pixel(p, x+i, y+j);
+    ssd1306_fill_rect(p, x, y, width, height, p->rop);
 }
 
 void ssd1306_draw_empty_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
-    ssd1306_draw_line(p, x, y, x+width, y);
-    ssd1306_draw_line(p, x, y+height, x+width, y+height);
-    ssd1306_draw_line(p, x, y, x, y+height);
-    ssd1306_draw_line(p, x+width, y, x+width, y+height);
+    // edges span x..x+width and y..y+height, corners are drawn once
+    const int32_t x1=x+width, y1=y+height;
+
+    ssd1306_fill_area(p, x, y, x1, y, p->rop);
+    if(height)
+        ssd1306_fill_area(p, x, y1, x1, y1, p->rop);
+    ssd1306_fill_area(p, x, y+1, x, y1-1, p->rop);
+    if(width)
+        ssd1306_fill_area(p, x1, y+1, x1, y1-1, p->rop);
+}
+
+#define SSD1306_MAX_RADIUS 127
+
+// first quadrant of a midpoint circle: row dy of the outline covers columns lo[dy]..hi[dy]
+static void ssd1306_circle_quadrant(uint32_t r, uint8_t *lo, uint8_t *hi) {
+    memset(lo, 0xFF, r+1);
+    memset(hi, 0, r+1);
+
+    int32_t x=r, y=0, err=1-(int32_t) r;
+    while(x>=y) {
+        if(x<lo[y]) lo[y]=x;
+        if(x>hi[y]) hi[y]=x;
+        if(y<lo[x]) lo[x]=y;
+        if(y>hi[x]) hi[x]=y;
+
+        ++y;
+        if(err<0) {
+            err+=2*y+1;
+        } else {
+            --x;
+            err+=2*(y-x)+1;
+        }
+    }
+}
+
+// draws a box with corners of radius r centered on (cx0, cy0) and (cx1, cy1), cx0<=cx1 and cy0<=cy1
+static void ssd1306_draw_rounded(ssd1306_t *p, int32_t cx0, int32_t cy0, int32_t cx1, int32_t cy1, uint32_t r, bool filled) {
+    uint8_t lo[SSD1306_MAX_RADIUS+1], hi[SSD1306_MAX_RADIUS+1];
+    ssd1306_circle_quadrant(r, lo, hi);
+
+    for(uint32_t dy=0; dy<=r; ++dy) {
+        for(int32_t row=cy0-(int32_t) dy;; row=cy1+dy) {
+            if(filled || !lo[dy]) {
+                ssd1306_fill_area(p, cx0-hi[dy], row, cx1+hi[dy], row, p->rop);
+            } else {
+                ssd1306_fill_area(p, cx0-hi[dy], row, cx0-lo[dy], row, p->rop);
+                ssd1306_fill_area(p, cx1+lo[dy], row, cx1+hi[dy], row, p->rop);
+            }
+            if(row==cy1+(int32_t) dy || (!dy && cy0==cy1))
+                break;
+        }
+    }
+
+    if(cy1-cy0<2) return;
+
+    if(filled) {
+        ssd1306_fill_area(p, cx0-r, cy0+1, cx1+r, cy1-1, p->rop);
+    } else {
+        ssd1306_fill_area(p, cx0-r, cy0+1, cx0-r, cy1-1, p->rop);
+        if(cx1+r!=cx0-r)
+            ssd1306_fill_area(p, cx1+r, cy0+1, cx1+r, cy1-1, p->rop);
+    }
+}
+
+void ssd1306_draw_circle(ssd1306_t *p, int32_t x, int32_t y, uint32_t r) {
+    if(r>SSD1306_MAX_RADIUS)
+        r=SSD1306_MAX_RADIUS;
+    ssd1306_draw_rounded(p, x, y, x, y, r, true);
+}
+
+void ssd1306_draw_empty_circle(ssd1306_t *p, int32_t x, int32_t y, uint32_t r) {
+    if(r>SSD1306_MAX_RADIUS)
+        r=SSD1306_MAX_RADIUS;
+    ssd1306_draw_rounded(p, x, y, x, y, r, false);
+}
+
+// clamps the radius so the corners fit, returns false for empty boxes
+static bool ssd1306_rounded_radius(uint32_t width, uint32_t height, uint32_t *r) {
+    if(!width || !height) return false;
+
+    const uint32_t max=((width<height?width:height)-1)/2;
+    if(*r>max)
+        *r=max;
+    if(*r>SSD1306_MAX_RADIUS)
+        *r=SSD1306_MAX_RADIUS;
+    return true;
+}
+
+void ssd1306_draw_rounded_square(ssd1306_t *p, int32_t x, int32_t y, uint32_t width, uint32_t height, uint32_t r) {
+    if(!ssd1306_rounded_radius(width, height, &r)) return;
+
+    ssd1306_draw_rounded(p, x+r, y+r, x+width-1-r, y+height-1-r, r, true);
+}
+
+void ssd1306_draw_empty_rounded_square(ssd1306_t *p, int32_t x, int32_t y, uint32_t width, uint32_t height, uint32_t r) {
+    if(!ssd1306_rounded_radius(width, height, &r)) return;
+
+    ssd1306_draw_rounded(p, x+r, y+r, x+width-1-r, y+height-1-r, r, false);
+}
+
+// draws a vertical strip of pixels (bit 0 at row y) into column x with the raster op of p, touching one byte per page it covers
+static void ssd1306_blit_column(ssd1306_t *p, int32_t x, int32_t y, uint32_t bits) {
+    if(x<0 || x>=p->width || y>p->clip_y1 || !bits) return;
+
+    if(p->clip_y1-y<31)
+        bits&=(2u<<(p->clip_y1-y))-1;
+    if(y<p->clip_y0) {
+        if(p->clip_y0-y>=32) return;
+        bits>>=p->clip_y0-y;
+        y=p->clip_y0;
+    }
+
+    uint32_t page=y>>3;
+    uint64_t v=(uint64_t) bits<<(y&7);
+    uint8_t *b=p->buffer+page*p->width+x;
+
+    for(; v && page<p->pages; ++page, v>>=8, b+=p->width) {
+        const uint8_t n=ssd1306_apply_rop(p->rop, *b, (uint8_t) v);
+        if(n!=*b) {
+            *b=n;
+            ssd1306_dirty_span(p, page, x, x);
+        }
+    }
+}
+
+// nibble to scaled bits, for scale 2, 3 and 4: every bit n becomes bits n*scale..n*scale+scale-1
+static const uint16_t ssd1306_spread_table[3][16]= {
+    {0x00, 0x03, 0x0C, 0x0F, 0x30, 0x33, 0x3C, 0x3F, 0xC0, 0xC3, 0xCC, 0xCF, 0xF0, 0xF3, 0xFC, 0xFF},
+    {0x0000, 0x0007, 0x0038, 0x003F, 0x01C0, 0x01C7, 0x01F8, 0x01FF, 0x0E00, 0x0E07, 0x0E38, 0x0E3F, 0x0FC0, 0x0FC7, 0x0FF8, 0x0FFF},
+    {0x0000, 0x000F, 0x00F0, 0x00FF, 0x0F00, 0x0F0F, 0x0FF0, 0x0FFF, 0xF000, 0xF00F, 0xF0F0, 0xF0FF, 0xFF00, 0xFF0F, 0xFFF0, 0xFFFF},
+};
+
+// stretches a column vertically, bits*scale must fit in 32 bits
+inline static uint32_t ssd1306_spread_bits(uint32_t bits, uint32_t scale) {
+    const uint16_t *t=ssd1306_spread_table[scale-2];
+    uint32_t out=0;
+
+    for(uint32_t shift=0; bits; bits>>=4, shift+=scale<<2)
+        out|=(uint32_t) t[bits&0xF]<<shift;
+    return out;
+}
+
+// whether glyphs of font at scale fit the column blit (stretched columns of at most 32 rows)
+inline static bool ssd1306_font_blittable(const uint8_t *font, uint32_t scale) {
+    return scale && scale<=4 && font[0]*scale<=32;
+}
+
+// column w of glyph c, stretched by scale, bit 0 at the top
+inline static uint32_t ssd1306_glyph_column(const uint8_t *font, char c, uint32_t w, uint32_t scale) {
+    const uint32_t parts_per_line=(font[0]>>3)+((font[0]&7)>0);
+    const uint8_t *col=font+(c-font[3])*font[1]*parts_per_line+w*parts_per_line+5;
+    uint32_t bits=0;
+
+    for(uint32_t lp=0; lp<parts_per_line; ++lp)
+        bits|=(uint32_t) col[lp]<<(lp<<3);
+    return scale>1?ssd1306_spread_bits(bits, scale):bits;
 }
 
 void ssd1306_draw_char_with_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, char c) {
     if(c<font[3]||c>font[4])
         return;
 
+    if(x>=p->width || y>=p->height)
+        return;
+
+    if(ssd1306_font_blittable(font, scale)) {
+        // font columns are already laid out like the pages, blit them whole (stretched for scale>1)
+        for(uint8_t w=0; w<font[1]; ++w) {
+            const uint32_t bits=ssd1306_glyph_column(font, c, w, scale);
+            for(uint32_t i=0; i<scale; ++i)
+                ssd1306_blit_column(p, x+w*scale+i, y, bits);
+        }
+        return;
+    }
+
     uint32_t parts_per_line=(font[0]>>3)+((font[0]&7)>0);
     for(uint8_t w=0; w<font[1]; ++w) { // width
         uint32_t pp=(c-font[3])*font[1]*parts_per_line+w*parts_per_line+5;
@@ -213,8 +660,78 @@ void ssd1306_draw_char_with_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t
     }
 }
 
+void ssd1306_set_text_cache(ssd1306_t *p, ssd1306_text_cache_t *cache) {
+    if(cache)
+        memset(cache, 0, sizeof(*cache));
+    p->text_cache=cache;
+}
+
+void ssd1306_set_show_hook(ssd1306_t *p, void (*hook)(void *ctx, const uint8_t *frame), void *ctx) {
+    p->show_hook=hook;
+    p->show_hook_ctx=ctx;
+}
+
+// finds the rendered run of s, rendering it into the least recently used entry on a miss
+static const ssd1306_text_cache_entry_t *ssd1306_text_cache_get(ssd1306_text_cache_t *cache, uint32_t scale, const uint8_t *font, const char *s) {
+    const size_t len=strlen(s);
+    const uint32_t advance=(font[1]+font[2])*scale;
+    const uint32_t width=len*advance, pages=(font[0]*scale+7)>>3;
+
+    if(len>SSD1306_TEXT_CACHE_TEXT || width>255 || width*pages>SSD1306_TEXT_CACHE_BYTES)
+        return NULL;
+
+    ssd1306_text_cache_entry_t *lru=&cache->entries[0];
+    for(size_t i=0; i<SSD1306_TEXT_CACHE_ENTRIES; ++i) {
+        ssd1306_text_cache_entry_t *e=&cache->entries[i];
+        if(e->used && e->font==font && e->scale==scale && !strcmp(e->text, s)) {
+            e->used=++cache->clock;
+            ++cache->hits;
+            return e;
+        }
+        if(e->used<lru->used)
+            lru=e;
+    }
+
+    ++cache->misses;
+    lru->used=++cache->clock;
+    lru->font=font;
+    lru->scale=scale;
+    lru->width=width;
+    lru->pages=pages;
+    memcpy(lru->text, s, len+1);
+    memset(lru->data, 0, width*pages);
+
+    for(size_t i=0; i<len; ++i) {
+        if(s[i]<font[3] || s[i]>font[4])
+            continue;
+        for(uint8_t w=0; w<font[1]; ++w) {
+            const uint32_t bits=ssd1306_glyph_column(font, s[i], w, scale);
+            for(uint32_t k=0; k<scale; ++k) {
+                uint8_t *col=lru->data+i*advance+w*scale+k;
+                for(uint32_t page=0; page<pages; ++page)
+                    col[page*width]=bits>>(page<<3);
+            }
+        }
+    }
+    return lru;
+}
+
 void ssd1306_draw_string_with_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, const char *s) {
-    for(int32_t x_n=x; *s; x_n+=(font[1]+font[2])*scale) {
+    if(p->text_cache && ssd1306_font_blittable(font, scale) && x<p->width && y<p->height) {
+        const ssd1306_text_cache_entry_t *e=ssd1306_text_cache_get(p->text_cache, scale, font, s);
+        if(e) {
+            const uint32_t width=e->width<p->width-x?e->width:p->width-x;
+            for(uint32_t col=0; col<width; ++col) {
+                uint32_t bits=0;
+                for(uint32_t page=0; page<e->pages; ++page)
+                    bits|=(uint32_t) e->data[page*e->width+col]<<(page<<3);
+                ssd1306_blit_column(p, x+col, y, bits);
+            }
+            return;
+        }
+    }
+
+    for(uint32_t x_n=x; *s && x_n<p->width; x_n+=(font[1]+font[2])*scale) {
         ssd1306_draw_char_with_font(p, x_n, y, scale, font, *(s++));
     }
 }
@@ -274,15 +791,81 @@ void ssd1306_bmp_show_image_with_offset(ssd1306_t *p, const uint8_t *data, const
 
     const uint8_t *img_data=data+bfOffBits;
 
-    int32_t step=biHeight>0?-1:1;
-    int32_t border=biHeight>0?-1:-biHeight;
+    // positive height: rows are stored bottom up
+    const bool bottom_up=biHeight>0;
+    const uint32_t rows=bottom_up?(uint32_t) biHeight:(uint32_t) -biHeight;
+
+    if(!rows || !biWidth || bfOffBits+(uint64_t) bytes_per_line*rows>(uint64_t) size) // truncated file
+        return;
+
+    if(x_offset>=p->width || y_offset>=p->height)
+        return;
+
+    const uint32_t y_start=y_offset>p->clip_y0?y_offset:p->clip_y0;
+    uint32_t y_end=rows<p->height-y_offset?y_offset+rows:p->height;
+    if(y_end>p->clip_y1+1u)
+        y_end=p->clip_y1+1u;
+    const uint32_t blocks=(biWidth+7)>>3;
+
+    // eight rows of a page at a time: each 8x8 block is transposed into eight page bytes
+    for(uint32_t page=y_start>>3; page<<3<y_end; ++page) {
+        const uint8_t *src[8];
+        for(uint32_t k=0; k<8; ++k) {
+            const uint32_t y=(page<<3)+k;
+            if(y<y_start || y>=y_end) {
+                src[k]=NULL;
+            } else {
+                const uint32_t row=y-y_offset;
+                src[k]=img_data+(bottom_up?rows-1-row:row)*bytes_per_line;
+            }
+        }
+
+        uint8_t *dst=p->buffer+page*p->width;
+        uint32_t first=p->width, last=0;
+
+        for(uint32_t bx=0; bx<blocks && x_offset+(bx<<3)<p->width; ++bx) {
+            // lit pixels are the ones with color_val, padding bits past the width are never lit
+            const uint8_t valid=bx+1<blocks || !(biWidth&7)?0xFF:0xFF<<(8-(biWidth&7));
+            uint8_t r[8];
+            for(uint32_t k=0; k<8; ++k)
+                r[k]=src[k]?(color_val?src[k][bx]:~src[k][bx])&valid:0;
 
-    for(uint32_t y=biHeight>0?biHeight-1:0; y!=(uint32_t)border; y+=step) {
-        for(uint32_t x=0; x<biWidth; ++x) {
-            if(((img_data[x>>3]>>(7-(x&7)))&1)==color_val)
-                ssd1306_draw_pixel(p, x_offset+x, y_offset+y);
+            // 8x8 transpose (hacker's delight), row 7 in the top byte so row k lands in bit k
+            uint32_t x=((uint32_t) r[7]<<24)|((uint32_t) r[6]<<16)|((uint32_t) r[5]<<8)|r[4];
+            uint32_t y=((uint32_t) r[3]<<24)|((uint32_t) r[2]<<16)|((uint32_t) r[1]<<8)|r[0];
+            if(!(x|y))
+                continue;
+
+            uint32_t t;
+            t=(x^(x>>7))&0x00AA00AA;
+            x=x^t^(t<<7);
+            t=(y^(y>>7))&0x00AA00AA;
+            y=y^t^(t<<7);
+            t=(x^(x>>14))&0x0000CCCC;
+            x=x^t^(t<<14);
+            t=(y^(y>>14))&0x0000CCCC;
+            y=y^t^(t<<14);
+            t=(x&0xF0F0F0F0)|((y>>4)&0x0F0F0F0F);
+            y=((x<<4)&0xF0F0F0F0)|(y&0x0F0F0F0F);
+            x=t;
+
+            const uint8_t cols[8]= {x>>24, x>>16, x>>8, x, y>>24, y>>16, y>>8, y};
+            for(uint32_t c=0; c<8; ++c) {
+                const uint32_t col=x_offset+(bx<<3)+c;
+                if(col>=p->width)
+                    break;
+                const uint8_t b=ssd1306_apply_rop(p->rop, dst[col], cols[c]);
+                if(b!=dst[col]) {
+                    dst[col]=b;
+                    if(col<first)
+                        first=col;
+                    last=col;
+                }
+            }
         }
-        img_data+=bytes_per_line;
+
+        if(first<=last)
+            ssd1306_dirty_span(p, page, first, last);
     }
 }
 
@@ -290,17 +873,243 @@ inline void ssd1306_bmp_show_image(ssd1306_t *p, const uint8_t *data, const long
     ssd1306_bmp_show_image_with_offset(p, data, size, 0, 0);
 }
 
+void ssd1306_draw_asset(ssd1306_t *p, int32_t x, int32_t y, const uint8_t *data, size_t size) {
+    if(size<SSD1306_ASSET_HEADER_SIZE || data[0]!=SSD1306_ASSET_MAGIC)
+        return;
+
+    const uint32_t width=data[1], pages=(data[2]+7)>>3;
+    if(!width)
+        return;
+
+    uint32_t col=0, page=0; // position of the next decoded byte
+    size_t i=SSD1306_ASSET_HEADER_SIZE;
+
+    while(page<pages && i<size) {
+        const uint8_t c=data[i++];
+        const bool run=c&0x80;
+
+        for(uint32_t count=(c&0x7F)+1; count && page<pages; --count) {
+            if(i>=size)
+                return;
+            const uint8_t b=run?data[i]:data[i++];
+            if(b)
+                ssd1306_blit_column(p, x+col, y+(int32_t) (page<<3), b);
+            if(++col==width) {
+                col=0;
+                ++page;
+            }
+        }
+        if(run)
+            ++i;
+    }
+}
+
+// column x of a buffer, row 0 in bit 0
+inline static uint64_t ssd1306_column_bits(const ssd1306_t *p, uint32_t x) {
+    uint64_t bits=0;
+    for(uint32_t page=0; page<p->pages; ++page)
+        bits|=(uint64_t) p->buffer[page*p->width+x]<<(page<<3);
+    return bits;
+}
+
+void ssd1306_blit(ssd1306_t *p, int32_t x, int32_t y, const ssd1306_t *src, const ssd1306_t *mask) {
+    if(x>=p->width || x<=-(int32_t) src->width || y>p->clip_y1 || y<=-(int32_t) src->height)
+        return;
+
+    // rows of src that land inside the clip rows
+    const int32_t top=p->clip_y0-y, bottom=p->clip_y1-y;
+    if(top>=src->height)
+        return;
+    uint64_t keep=src->height<64?(1ull<<src->height)-1:~0ull;
+    if(top>0)
+        keep&=~0ull<<top;
+    if(bottom<63)
+        keep&=(2ull<<bottom)-1;
+
+    // rows above the display are shifted out, the rest starts at bit off of the first page
+    const uint32_t up=y<0?-y:0, off=y<0?0:y&7, first_page=y<0?0:y>>3;
+    const uint32_t x0=x<0?-x:0, x1=src->width<p->width-x?src->width:p->width-x;
+
+    for(uint32_t cx=x0; cx<x1; ++cx) {
+        const uint64_t m=(mask?ssd1306_column_bits(mask, cx):~0ull)&keep;
+        if(!m)
+            continue;
+        const uint64_t s=ssd1306_column_bits(src, cx)&m;
+        const uint32_t col=x+cx;
+        uint8_t *b=p->buffer+first_page*p->width+col;
+
+        for(uint32_t page=first_page, k=0; page<p->pages; ++page, ++k, b+=p->width) {
+            const uint32_t shift=(k<<3)+up;
+            if(k && shift-off>=64)
+                break;
+            const uint8_t mb=k?(m>>(shift-off)):(m>>up)<<off;
+            const uint8_t sb=k?(s>>(shift-off)):(s>>up)<<off;
+            if(!mb)
+                continue;
+
+            const uint8_t n=p->rop==SSD1306_ROP_SET?(*b&~mb)|sb:ssd1306_apply_rop(p->rop, *b, sb);
+            if(n!=*b) {
+                *b=n;
+                ssd1306_dirty_span(p, page, col, col);
+            }
+        }
+    }
+}
+
+// starts sending columns x0..x1 of pages page..last of buf, returns the start of the data in flight
+// or NULL if the bus failed. the byte in front of it (or the spare byte in front of the buffer) is
+// the transport's headroom, its value is kept in *saved until ssd1306_send_finish
+static uint8_t *ssd1306_send_start(ssd1306_t *p, uint8_t *buf, uint32_t page, uint32_t last, uint32_t x0, uint32_t x1, uint8_t *saved, uint32_t *bytes) {
+    const uint8_t col_offset=p->width==64?32:0;
+    const uint32_t ram_page=(page+(p->start_line>>3))&(SSD1306_MAX_PAGES-1);
+
+    uint8_t payload[]= {SET_COL_ADDR, x0+col_offset, x1+col_offset, SET_PAGE_ADDR, ram_page, ram_page+(last-page)};
+    if(!ssd1306_write_cmds(p, payload, sizeof(payload)))
+        return NULL;
+    *bytes+=sizeof(payload);
+
+    uint8_t *data=buf+page*p->width+x0;
+    const size_t len=(last-page)*p->width+(x1-x0+1);
+    *saved=data[-1];
+
+    for(uint32_t attempt=0;; ++attempt) {
+        ++p->stats.transactions;
+        const int ret=p->transport->write_data(p->transport_ctx, data, len);
+        if(ret>=0)
+            break;
+        if(!ssd1306_retry(p, ret, attempt)) {
+            data[-1]=*saved;
+            return NULL;
+        }
+    }
+
+    *bytes+=len;
+    return data;
+}
+
+static void ssd1306_send_finish(ssd1306_t *p, uint8_t *data, uint8_t saved) {
+    if(p->transport->wait)
+        p->transport->wait(p->transport_ctx);
+    data[-1]=saved;
+}
+
+// counts a show, and hands buf to the show hook if it was sent in full
+static void ssd1306_count_show(ssd1306_t *p, const uint8_t *buf, uint32_t bytes, uint32_t transactions, bool failed) {
+    ++p->stats.shows;
+    p->stats.last_show_bytes=bytes;
+    p->stats.total_bytes+=bytes;
+    p->stats.last_show_transactions=p->stats.transactions-transactions;
+
+    if(p->show_hook && bytes && !failed)
+        p->show_hook(p->show_hook_ctx, buf);
+}
+
+// sends the spans x0[page]..x1[page] of buf and resets them. if the bus fails, the spans not sent
+// are kept for the next call
+static void ssd1306_send(ssd1306_t *p, uint8_t *buf, uint8_t *x0s, uint8_t *x1s) {
+    const uint32_t transactions=p->stats.transactions;
+    uint32_t bytes=0;
+    bool failed=false;
+
+    if(!p->transport) { // canvas
+        ssd1306_span_reset(x0s, x1s);
+        return;
+    }
+
+    for(uint32_t page=0; page<p->pages; ++page) {
+        if(x0s[page]>x1s[page])
+            continue;
+
+        const uint32_t x0=x0s[page], x1=x1s[page];
+        const uint32_t ram_page=(page+(p->start_line>>3))&(SSD1306_MAX_PAGES-1);
+        uint32_t last=page;
+
+        // full width pages are contiguous in the buffer and share one window, unless the ram page wraps
+        if(x0==0 && x1==p->width-1u)
+            while(last+1<p->pages && ram_page+(last+1-page)<SSD1306_MAX_PAGES && x0s[last+1]==0 && x1s[last+1]==p->width-1u)
+                ++last;
+
+        uint8_t saved;
+        uint8_t *data=ssd1306_send_start(p, buf, page, last, x0, x1, &saved, &bytes);
+        if(!data) {
+            failed=true;
+            break;
+        }
+        ssd1306_send_finish(p, data, saved);
+
+        for(; page<=last; ++page) {
+            x0s[page]=0xFF;
+            x1s[page]=0;
+        }
+        page=last;
+    }
+
+    ssd1306_count_show(p, buf, bytes, transactions, failed);
+}
+
+void ssd1306_commit(ssd1306_t *p) {
+    for(uint32_t page=0; page<p->pages; ++page) {
+        const uint8_t x0=p->dirty_x0[page], x1=p->dirty_x1[page];
+        if(x0>x1)
+            continue;
+
+        memcpy(p->front+page*p->width+x0, p->buffer+page*p->width+x0, x1-x0+1);
+        if(x0<p->front_x0[page])
+            p->front_x0[page]=x0;
+        if(x1>p->front_x1[page])
+            p->front_x1[page]=x1;
+    }
+
+    ssd1306_span_reset(p->dirty_x0, p->dirty_x1);
+}
+
+void ssd1306_flush(ssd1306_t *p) {
+    ssd1306_send(p, p->front, p->front_x0, p->front_x1);
+}
+
 void ssd1306_show(ssd1306_t *p) {
-    uint8_t payload[]= {SET_COL_ADDR, 0, p->width-1, SET_PAGE_ADDR, 0, p->pages-1};
-    if(p->width==64) {
-        payload[1]+=32;
-        payload[2]+=32;
+    if(p->front) {
+        ssd1306_commit(p);
+        ssd1306_flush(p);
+    } else {
+        ssd1306_send(p, p->buffer, p->dirty_x0, p->dirty_x1);
     }
+}
+
+void ssd1306_show_paged(ssd1306_t *p, ssd1306_render_t render, void *ctx) {
+    const uint8_t clip_y0=p->clip_y0, clip_y1=p->clip_y1;
+    const uint32_t transactions=p->stats.transactions;
+    uint32_t bytes=0;
+    uint8_t *pending=NULL, saved=0;
+    bool failed=!p->transport;
+
+    for(uint32_t page=0; page<p->pages; ++page) {
+        // draw page n while page n-1 is on the bus
+        p->clip_y0=page<<3;
+        p->clip_y1=(page<<3)+7;
+        render(p, ctx);
+
+        if(pending) {
+            ssd1306_send_finish(p, pending, saved);
+            pending=NULL;
+        }
 
-    for(size_t i=0; i<sizeof(payload); ++i)
-        ssd1306_write(p, payload[i]);
+        // after a bus failure the remaining pages stay dirty for the next show
+        if(!failed && p->dirty_x0[page]<=p->dirty_x1[page]) {
+            pending=ssd1306_send_start(p, p->buffer, page, page, p->dirty_x0[page], p->dirty_x1[page], &saved, &bytes);
+            if(pending) {
+                p->dirty_x0[page]=0xFF;
+                p->dirty_x1[page]=0;
+            } else {
+                failed=true;
+            }
+        }
+    }
 
-    *(p->buffer-1)=0x40;
+    if(pending)
+        ssd1306_send_finish(p, pending, saved);
 
-    fancy_write(p->i2c_i, p->address, p->buffer-1, p->bufsize+1, "ssd1306_show");
+    p->clip_y0=clip_y0;
+    p->clip_y1=clip_y1;
+    ssd1306_count_show(p, p->buffer, bytes, transactions, failed);
 }
@@ -0,0 +1,59 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 David Schramm
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "ssd1306_async.h"
+
+static void ssd1306_async_task(void *pvParameters) {
+    ssd1306_async_t *a=pvParameters;
+
+    while(1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        ssd1306_flush(a->disp);
+        xSemaphoreGive(a->idle);
+    }
+}
+
+bool ssd1306_async_start(ssd1306_async_t *a, ssd1306_t *p, UBaseType_t priority) {
+    if(!ssd1306_enable_double_buffer(p))
+        return false;
+
+    a->disp=p;
+    if((a->idle=xSemaphoreCreateBinary())==NULL)
+        return false;
+    xSemaphoreGive(a->idle);
+
+    return xTaskCreate(ssd1306_async_task, "SSD1306", 512, a, priority, &a->task)==pdPASS;
+}
+
+void ssd1306_async_show(ssd1306_async_t *a) {
+    xSemaphoreTake(a->idle, portMAX_DELAY);
+    ssd1306_commit(a->disp);
+    xTaskNotifyGive(a->task);
+}
+
+void ssd1306_async_wait(ssd1306_async_t *a) {
+    xSemaphoreTake(a->idle, portMAX_DELAY);
+    xSemaphoreGive(a->idle);
+}
@@ -0,0 +1,147 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 David Schramm
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <pico/stdlib.h>
+#include <hardware/i2c.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ssd1306.h"
+#include "ssd1306_i2c.h"
+
+// time allowed for a write of len bytes, enough for 100 kHz plus clock stretching
+#define SSD1306_I2C_TIMEOUT_US(len) (1000+(len)*100)
+
+// errors are returned to the driver, which counts and retries them (ssd1306_t stats)
+inline static int fancy_write(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len) {
+    return i2c_write_timeout_us(i2c, addr, src, len, false, SSD1306_I2C_TIMEOUT_US(len));
+}
+
+// longest command sequence sent in one transaction, longer ones are split
+#define SSD1306_I2C_CMD_CHUNK 32
+
+static int ssd1306_i2c_write_cmds(void *ctx, const uint8_t *cmds, size_t len) {
+    ssd1306_i2c_t *b=ctx;
+    uint8_t d[SSD1306_I2C_CMD_CHUNK+1];
+
+    // a single control byte (Co=0, D/C=0) covers the whole sequence
+    d[0]=0x00;
+    for(size_t i=0; i<len; i+=SSD1306_I2C_CMD_CHUNK) {
+        const size_t n=len-i<SSD1306_I2C_CMD_CHUNK?len-i:SSD1306_I2C_CMD_CHUNK;
+        memcpy(d+1, cmds+i, n);
+        int ret=fancy_write(b->i2c, b->address, d, n+1);
+        if(ret<0)
+            return ret;
+    }
+    return len;
+}
+
+static int ssd1306_i2c_write_data(void *ctx, uint8_t *data, size_t len) {
+    ssd1306_i2c_t *b=ctx;
+
+    data[-1]=0x40;
+    int ret=fancy_write(b->i2c, b->address, data-1, len+1);
+    return ret<0?ret:(int) len;
+}
+
+static void ssd1306_i2c_delay(void *ctx, uint32_t us) {
+    (void) ctx;
+    sleep_us(us);
+}
+
+// clocks scl until the slave releases sda, ends with a stop and sets the peripheral up again
+static int ssd1306_i2c_recover(void *ctx) {
+    ssd1306_i2c_t *b=ctx;
+    if(!b->baudrate)
+        return PICO_ERROR_GENERIC; // pins unknown, see ssd1306_i2c_enable_recovery
+
+    i2c_deinit(b->i2c);
+
+    // open drain by hand: a pin is pulled low as output 0 and released as input
+    gpio_set_function(b->sda, GPIO_FUNC_SIO);
+    gpio_set_function(b->scl, GPIO_FUNC_SIO);
+    gpio_put(b->sda, 0);
+    gpio_put(b->scl, 0);
+    gpio_set_dir(b->sda, GPIO_IN);
+    gpio_set_dir(b->scl, GPIO_IN);
+
+    for(uint32_t i=0; i<9 && !gpio_get(b->sda); ++i) {
+        gpio_set_dir(b->scl, GPIO_OUT);
+        sleep_us(5);
+        gpio_set_dir(b->scl, GPIO_IN);
+        sleep_us(5);
+    }
+
+    // stop: sda rises while scl is high
+    gpio_set_dir(b->scl, GPIO_OUT);
+    gpio_set_dir(b->sda, GPIO_OUT);
+    sleep_us(5);
+    gpio_set_dir(b->scl, GPIO_IN);
+    sleep_us(5);
+    gpio_set_dir(b->sda, GPIO_IN);
+    sleep_us(5);
+    const bool released=gpio_get(b->sda) && gpio_get(b->scl);
+
+    gpio_set_function(b->sda, GPIO_FUNC_I2C);
+    gpio_set_function(b->scl, GPIO_FUNC_I2C);
+    i2c_init(b->i2c, b->baudrate);
+
+    return released?0:PICO_ERROR_GENERIC;
+}
+
+const ssd1306_transport_t ssd1306_i2c_transport= {
+    .write_cmds=ssd1306_i2c_write_cmds,
+    .write_data=ssd1306_i2c_write_data,
+    .wait=NULL,
+    .delay=ssd1306_i2c_delay,
+    .recover=ssd1306_i2c_recover,
+};
+
+void ssd1306_i2c_enable_recovery(ssd1306_i2c_t *b, uint sda, uint scl, uint baudrate) {
+    b->sda=sda;
+    b->scl=scl;
+    b->baudrate=baudrate;
+}
+
+bool ssd1306_init_i2c_static(ssd1306_t *p, uint16_t width, uint16_t height, ssd1306_i2c_t *b, uint8_t address, i2c_inst_t *i2c_instance, uint8_t *storage) {
+    b->i2c=i2c_instance;
+    b->address=address;
+    b->baudrate=0;
+
+    return ssd1306_init_static(p, width, height, storage, &ssd1306_i2c_transport, b);
+}
+
+bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address, i2c_inst_t *i2c_instance) {
+    ssd1306_i2c_t *b=malloc(sizeof(ssd1306_i2c_t));
+    if(!b)
+        return false;
+
+    if(!ssd1306_init_i2c_static(p, width, height, b, address, i2c_instance, NULL)) {
+        free(b);
+        return false;
+    }
+    p->owns_transport_ctx=true;
+    return true;
+}
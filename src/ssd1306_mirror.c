@@ -0,0 +1,169 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "ssd1306_mirror.h"
+
+_Static_assert(SSD1306_MIRROR_STREAM_SIZE>=SSD1306_MIRROR_HEADER+SSD1306_MIRROR_MAX_ENCODED(SSD1306_MIRROR_FRAME), "mirror stream buffer too small");
+
+// number of equal bytes of frame and ref from i on. frame and ref have the same alignment,
+// so once aligned they are compared a word at a time
+static size_t ssd1306_mirror_unchanged(const uint8_t *frame, const uint8_t *ref, size_t i, size_t len) {
+    const size_t start=i;
+
+    for(; i<len && ((uintptr_t)(frame+i)&3); ++i)
+        if(frame[i]!=ref[i])
+            return i-start;
+
+    for(; i+4<=len; i+=4) {
+        uint32_t a, b;
+        memcpy(&a, __builtin_assume_aligned(frame+i, 4), 4);
+        memcpy(&b, __builtin_assume_aligned(ref+i, 4), 4);
+        if(a!=b)
+            break;
+    }
+
+    for(; i<len && frame[i]==ref[i]; ++i);
+    return i-start;
+}
+
+// literal blocks for the difference of bytes from..to-1
+static uint8_t *ssd1306_mirror_literal(uint8_t *o, const uint8_t *frame, const uint8_t *ref, size_t from, size_t to) {
+    while(from<to) {
+        const size_t n=to-from<128?to-from:128;
+        *o++=n-1;
+        for(size_t i=0; i<n; ++i, ++from)
+            *o++=frame[from]^ref[from];
+    }
+    return o;
+}
+
+// encodes the difference of frame and ref into out, returns its size
+static size_t ssd1306_mirror_encode(const uint8_t *frame, const uint8_t *ref, size_t len, uint8_t *out) {
+    uint8_t *o=out;
+    size_t literal=0; // first byte not encoded yet
+
+    for(size_t i=0; i<len;) {
+        const uint8_t d=frame[i]^ref[i];
+        size_t run=1;
+
+        if(d==0)
+            run=ssd1306_mirror_unchanged(frame, ref, i, len);
+        else
+            while(i+run<len && (frame[i+run]^ref[i+run])==d)
+                ++run;
+
+        // unchanged bytes at the end are left out
+        if(d==0 && i+run==len)
+            return ssd1306_mirror_literal(o, frame, ref, literal, i)-out;
+
+        // a repeat block costs two bytes, shorter runs stay literal
+        if(run<3) {
+            i+=run;
+            continue;
+        }
+
+        o=ssd1306_mirror_literal(o, frame, ref, literal, i);
+        for(i+=run; run;) {
+            const size_t n=run<128?run:128;
+            *o++=0x7F+n;
+            *o++=d;
+            run-=n;
+        }
+        literal=i;
+    }
+
+    return ssd1306_mirror_literal(o, frame, ref, literal, len)-out;
+}
+
+// show hook: encodes the frame and queues it without waiting
+static void ssd1306_mirror_hook(void *ctx, const uint8_t *frame) {
+    ssd1306_mirror_t *m=ctx;
+    const size_t len=m->disp->bufsize;
+    const uint8_t align=(uintptr_t)frame&3;
+    uint8_t *ref=(uint8_t *)m->ref+align;
+
+    // the reference is kept at the alignment of the frames, a new alignment starts over
+    if(align!=m->align || m->since_key>=SSD1306_MIRROR_KEYFRAME_INTERVAL) {
+        m->align=align;
+        m->key=true;
+    }
+    if(m->key)
+        memset(ref, 0, len);
+
+    const size_t n=ssd1306_mirror_encode(frame, ref, len, m->msg+SSD1306_MIRROR_HEADER);
+    if(n==0 && !m->key)
+        return;
+
+    m->msg[0]=m->key?'K':'D';
+    m->msg[1]=m->seq;
+    m->msg[2]=n&0xFF;
+    m->msg[3]=n>>8;
+
+    // a dropped frame leaves the reference alone, the next one carries its changes
+    if(xStreamBufferSpacesAvailable(m->stream)<SSD1306_MIRROR_HEADER+n) {
+        ++m->dropped;
+        return;
+    }
+    xStreamBufferSend(m->stream, m->msg, SSD1306_MIRROR_HEADER+n, 0);
+    memcpy(ref, frame, len);
+
+    ++m->seq;
+    ++m->frames;
+    m->bytes+=n;
+    if(m->key) {
+        ++m->keyframes;
+        m->since_key=0;
+        m->key=false;
+    } else {
+        ++m->since_key;
+    }
+}
+
+static void ssd1306_mirror_receive(ssd1306_mirror_t *m, uint8_t *buf, size_t len) {
+    while(len) {
+        const size_t n=xStreamBufferReceive(m->stream, buf, len, portMAX_DELAY);
+        buf+=n;
+        len-=n;
+    }
+}
+
+static void ssd1306_mirror_task(void *pvParameters) {
+    static const char hex[]="0123456789ABCDEF";
+    ssd1306_mirror_t *m=pvParameters;
+    uint8_t head[SSD1306_MIRROR_HEADER], chunk[32];
+
+    while(1) {
+        ssd1306_mirror_receive(m, head, sizeof(head));
+        char *o=m->line+snprintf(m->line, 32, "@OLED %c %u %ux%u ", head[0], head[1], m->disp->width, m->disp->height);
+
+        // the whole line goes out in one write, so other output cannot land inside it
+        for(size_t len=head[2]|head[3]<<8; len;) {
+            const size_t n=len<sizeof(chunk)?len:sizeof(chunk);
+            ssd1306_mirror_receive(m, chunk, n);
+            for(size_t i=0; i<n; ++i) {
+                *o++=hex[chunk[i]>>4];
+                *o++=hex[chunk[i]&0x0F];
+            }
+            len-=n;
+        }
+        *o++='\n';
+        fwrite(m->line, 1, o-m->line, stdout);
+    }
+}
+
+bool ssd1306_mirror_start(ssd1306_mirror_t *m, ssd1306_t *p, UBaseType_t priority) {
+    m->disp=p;
+    m->frames=m->keyframes=m->dropped=m->bytes=0;
+    m->seq=0;
+    m->since_key=0;
+    m->align=0;
+    m->key=true;
+
+    if((m->stream=xStreamBufferCreate(SSD1306_MIRROR_STREAM_SIZE, 1))==NULL)
+        return false;
+    if(xTaskCreate(ssd1306_mirror_task, "Mirror", 512, m, priority, &m->task)!=pdPASS)
+        return false;
+
+    ssd1306_set_show_hook(p, ssd1306_mirror_hook, m);
+    return true;
+}
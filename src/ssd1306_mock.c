@@ -0,0 +1,259 @@
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+#include "ssd1306.h"
+#include "ssd1306_mock.h"
+
+// arguments following each command byte
+static size_t ssd1306_mock_args(uint8_t cmd) {
+    switch(cmd) {
+    case SET_HSCROLL:
+    case SET_HSCROLL+1:
+        return 6;
+    case SET_VHSCROLL:
+    case SET_VHSCROLL+1:
+        return 5;
+    case SET_COL_ADDR:
+    case SET_PAGE_ADDR:
+    case SET_SCROLL_AREA:
+        return 2;
+    case SET_CONTRAST:
+    case SET_MEM_ADDR:
+    case SET_MUX_RATIO:
+    case SET_DISP_OFFSET:
+    case SET_COM_PIN_CFG:
+    case SET_DISP_CLK_DIV:
+    case SET_PRECHARGE:
+    case SET_VCOM_DESEL:
+    case SET_CHARGE_PUMP:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static void ssd1306_mock_exec(ssd1306_mock_t *m) {
+    const uint8_t *c=m->cmd;
+
+    switch(c[0]) {
+    case SET_COL_ADDR:
+        m->col_start=m->col=c[1]&0x7F;
+        m->col_end=c[2]&0x7F;
+        break;
+    case SET_PAGE_ADDR:
+        m->page_start=m->page=c[1]&0x07;
+        m->page_end=c[2]&0x07;
+        break;
+    case SET_CONTRAST:
+        m->contrast=c[1];
+        break;
+    case SET_DISP:
+    case SET_DISP|0x01:
+        m->display_on=c[0]&1;
+        break;
+    case SET_NORM_INV:
+    case SET_NORM_INV|0x01:
+        m->inverted=c[0]&1;
+        break;
+    case SET_HSCROLL:
+    case SET_HSCROLL+1:
+    case SET_VHSCROLL:
+    case SET_VHSCROLL+1:
+        // ignored while scrolling, like the panel does
+        if(m->scrolling)
+            break;
+        m->scroll_left=c[0]==SET_HSCROLL+1 || c[0]==SET_VHSCROLL+1;
+        m->scroll_start_page=c[2]&0x07;
+        m->scroll_interval=c[3]&0x07;
+        m->scroll_end_page=c[4]&0x07;
+        m->scroll_vertical=c[0]>=SET_VHSCROLL?c[5]&0x3F:0;
+        break;
+    case SET_SCROLL_AREA:
+        m->scroll_top=c[1]&0x3F;
+        m->scroll_rows=c[2]&0x7F;
+        break;
+    case SET_SCROLL:
+    case SET_SCROLL|0x01:
+        m->scrolling=c[0]&1;
+        m->scroll_offset=0;
+        break;
+    default:
+        if((c[0]&0xC0)==SET_DISP_START_LINE)
+            m->start_line=c[0]&0x3F;
+        break;
+    }
+}
+
+static void ssd1306_mock_bus(ssd1306_mock_t *m, size_t len) {
+    const uint64_t ns=(uint64_t) len*m->ns_per_byte;
+    m->bus_ns+=ns;
+
+    if(ns) {
+        // sleeps until a deadline: a signal (the tick of the FreeRTOS posix port) does not cut the
+        // bus time short, and a task preempted meanwhile finds the bus done, as with a real transfer
+        struct timespec t;
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        t.tv_sec+=ns/1000000000u;
+        t.tv_nsec+=ns%1000000000u;
+        if(t.tv_nsec>=1000000000) {
+            ++t.tv_sec;
+            t.tv_nsec-=1000000000;
+        }
+        while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL)==EINTR);
+    }
+}
+
+// error code of the injected fault hitting this write, 0 if it goes through
+static int ssd1306_mock_fault(ssd1306_mock_t *m) {
+    ++m->writes;
+
+    int err=0;
+    if(m->stuck)
+        err=SSD1306_MOCK_TIMEOUT;
+    else if(m->fail_next && m->fail_next--)
+        err=SSD1306_MOCK_NACK;
+    else if(m->fail_every && !(m->writes%m->fail_every))
+        err=SSD1306_MOCK_NACK;
+
+    if(err)
+        ++m->failed_writes;
+    return err;
+}
+
+static int ssd1306_mock_write_cmds(void *ctx, const uint8_t *cmds, size_t len) {
+    ssd1306_mock_t *m=ctx;
+
+    const int err=ssd1306_mock_fault(m);
+    if(err)
+        return err;
+
+    for(size_t i=0; i<len; ++i) {
+        m->cmd[m->cmd_len++]=cmds[i];
+        if(m->cmd_len>ssd1306_mock_args(m->cmd[0])) {
+            ssd1306_mock_exec(m);
+            m->cmd_len=0;
+        }
+    }
+
+    m->cmd_bytes+=len;
+    ++m->cmd_transactions;
+    ssd1306_mock_bus(m, len);
+    return len;
+}
+
+static int ssd1306_mock_write_data(void *ctx, uint8_t *data, size_t len) {
+    ssd1306_mock_t *m=ctx;
+
+    const int err=ssd1306_mock_fault(m);
+    if(err)
+        return err;
+
+    // horizontal addressing: wrap to the next page at the end of the column window
+    for(size_t i=0; i<len; ++i) {
+        m->gddram[m->page][m->col]=data[i];
+        if(m->col++>=m->col_end) {
+            m->col=m->col_start;
+            if(m->page++>=m->page_end)
+                m->page=m->page_start;
+        }
+    }
+
+    if(m->scrolling)
+        ++m->writes_while_scrolling;
+    m->data_bytes+=len;
+    ++m->data_transactions;
+    ssd1306_mock_bus(m, len);
+    return len;
+}
+
+static void ssd1306_mock_delay(void *ctx, uint32_t us) {
+    ssd1306_mock_t *m=ctx;
+    m->delay_us+=us;
+}
+
+static int ssd1306_mock_recover(void *ctx) {
+    ssd1306_mock_t *m=ctx;
+
+    ++m->recoveries;
+    if(m->recover_fails)
+        return SSD1306_MOCK_TIMEOUT;
+    m->stuck=false;
+    return 0;
+}
+
+const ssd1306_transport_t ssd1306_mock_transport= {
+    .write_cmds=ssd1306_mock_write_cmds,
+    .write_data=ssd1306_mock_write_data,
+    .wait=NULL,
+    .delay=ssd1306_mock_delay,
+    .recover=ssd1306_mock_recover,
+};
+
+void ssd1306_mock_init(ssd1306_mock_t *m, uint32_t ns_per_byte) {
+    memset(m, 0, sizeof(*m));
+    m->col_end=SSD1306_MOCK_COLUMNS-1;
+    m->page_end=SSD1306_MAX_PAGES-1;
+    m->contrast=0x7F;
+    m->scroll_rows=64;
+    m->ns_per_byte=ns_per_byte;
+}
+
+void ssd1306_mock_scroll_step(ssd1306_mock_t *m) {
+    if(!m->scrolling)
+        return;
+
+    // the panel rotates the ram of the scrolled pages by one column
+    for(uint32_t page=m->scroll_start_page; page<=m->scroll_end_page; ++page) {
+        uint8_t *row=m->gddram[page];
+        if(m->scroll_left) {
+            const uint8_t first=row[0];
+            memmove(row, row+1, SSD1306_MOCK_COLUMNS-1);
+            row[SSD1306_MOCK_COLUMNS-1]=first;
+        } else {
+            const uint8_t last=row[SSD1306_MOCK_COLUMNS-1];
+            memmove(row+1, row, SSD1306_MOCK_COLUMNS-1);
+            row[0]=last;
+        }
+    }
+
+    if(m->scroll_vertical && m->scroll_rows)
+        m->scroll_offset=(m->scroll_offset+m->scroll_vertical)%m->scroll_rows;
+}
+
+// ram row shown on display row y
+static uint32_t ssd1306_mock_row(const ssd1306_mock_t *m, uint32_t y) {
+    if(m->scrolling && y>=m->scroll_top && y<(uint32_t) m->scroll_top+m->scroll_rows)
+        y=m->scroll_top+(y-m->scroll_top+m->scroll_offset)%m->scroll_rows;
+    return (y+m->start_line)&0x3F;
+}
+
+bool ssd1306_mock_matches(const ssd1306_mock_t *m, const ssd1306_t *p) {
+    const uint32_t col_offset=p->width==64?32:0;
+
+    for(uint32_t page=0; page<p->pages; ++page)
+        if(memcmp(&m->gddram[(page+(m->start_line>>3))&(SSD1306_MAX_PAGES-1)][col_offset], p->buffer+page*p->width, p->width))
+            return false;
+    return true;
+}
+
+bool ssd1306_mock_write_pbm(const ssd1306_mock_t *m, uint32_t width, uint32_t height, FILE *f) {
+    const uint32_t col_offset=width==64?32:0;
+
+    if(fprintf(f, "P4\n%u %u\n", (unsigned) width, (unsigned) height)<0)
+        return false;
+
+    // pbm rows are msb first, 1 is black: lit pixels are written as black
+    for(uint32_t y=0; y<height; ++y) {
+        const uint32_t row=ssd1306_mock_row(m, y);
+        for(uint32_t x=0; x<width; x+=8) {
+            uint8_t b=0;
+            for(uint32_t i=0; i<8 && x+i<width; ++i)
+                if((m->gddram[row>>3][col_offset+x+i]>>(row&7))&1)
+                    b|=0x80>>i;
+            if(fputc(b, f)==EOF)
+                return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,94 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 David Schramm
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <pico/stdlib.h>
+#include <hardware/spi.h>
+#include <hardware/dma.h>
+
+#include "ssd1306.h"
+#include "ssd1306_spi.h"
+
+static int ssd1306_spi_write(ssd1306_spi_t *s, bool data, const uint8_t *src, size_t len) {
+    gpio_put(s->dc, data);
+    gpio_put(s->cs, 0);
+    int ret=spi_write_blocking(s->spi, src, len);
+    gpio_put(s->cs, 1);
+    return ret;
+}
+
+static int ssd1306_spi_write_cmds(void *ctx, const uint8_t *cmds, size_t len) {
+    return ssd1306_spi_write(ctx, false, cmds, len);
+}
+
+static int ssd1306_spi_write_data(void *ctx, uint8_t *data, size_t len) {
+    ssd1306_spi_t *s=ctx;
+
+    // the data/command pin replaces the i2c control byte, no headroom needed
+    if(!s->dma_enabled)
+        return ssd1306_spi_write(s, true, data, len);
+
+    gpio_put(s->dc, 1);
+    gpio_put(s->cs, 0);
+
+    dma_channel_config c=dma_channel_get_default_config(s->dma);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_dreq(&c, spi_get_dreq(s->spi, true));
+    channel_config_set_write_increment(&c, false);
+    dma_channel_configure(s->dma, &c, &spi_get_hw(s->spi)->dr, data, len, true);
+    return len;
+}
+
+static void ssd1306_spi_wait(void *ctx) {
+    ssd1306_spi_t *s=ctx;
+    if(!s->dma_enabled)
+        return;
+
+    dma_channel_wait_for_finish_blocking(s->dma);
+    while(spi_is_busy(s->spi))
+        tight_loop_contents();
+
+    // drop what was clocked in while sending, like spi_write_blocking does
+    while(spi_is_readable(s->spi))
+        (void) spi_get_hw(s->spi)->dr;
+    spi_get_hw(s->spi)->icr=SPI_SSPICR_RORIC_BITS;
+
+    gpio_put(s->cs, 1);
+}
+
+bool ssd1306_spi_enable_dma(ssd1306_spi_t *s) {
+    const int dma=dma_claim_unused_channel(false);
+    if(dma<0)
+        return false;
+
+    s->dma=dma;
+    s->dma_enabled=true;
+    return true;
+}
+
+const ssd1306_transport_t ssd1306_spi_transport= {
+    .write_cmds=ssd1306_spi_write_cmds,
+    .write_data=ssd1306_spi_write_data,
+    .wait=ssd1306_spi_wait,
+};
@@ -0,0 +1,317 @@
+#include <string.h>
+
+#include "ssd1306_ui.h"
+
+// whether w and all its groups are visible
+static bool ssd1306_ui_shown(const ssd1306_widget_t *w) {
+    for(; w; w=w->parent)
+        if(!w->visible)
+            return false;
+    return true;
+}
+
+inline static uint32_t ssd1306_ui_area(const ssd1306_ui_rect_t *r) {
+    return (r->x1-r->x0+1u)*(r->y1-r->y0+1u);
+}
+
+inline static void ssd1306_ui_union(ssd1306_ui_rect_t *q, const ssd1306_ui_rect_t *r) {
+    if(r->x0<q->x0) q->x0=r->x0;
+    if(r->y0<q->y0) q->y0=r->y0;
+    if(r->x1>q->x1) q->x1=r->x1;
+    if(r->y1>q->y1) q->y1=r->y1;
+}
+
+// records a rectangle to redraw. rectangles that overlap or touch one already recorded are merged
+// with it, and once the list is full a new one is merged where it adds the least area
+static void ssd1306_ui_invalidate(ssd1306_ui_t *ui, int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+    const ssd1306_t *p=ui->disp;
+
+    if(x0<0) x0=0;
+    if(y0<0) y0=0;
+    if(x1>=p->width) x1=p->width-1;
+    if(y1>=p->height) y1=p->height-1;
+    if(x0>x1 || y0>y1)
+        return;
+
+    const ssd1306_ui_rect_t r= {x0, y0, x1, y1};
+    uint32_t best=0, best_growth=UINT32_MAX;
+
+    for(uint32_t i=0; i<ui->rect_count; ++i) {
+        ssd1306_ui_rect_t *q=&ui->rects[i];
+        if(r.x0<=q->x1+1 && q->x0<=r.x1+1 && r.y0<=q->y1+1 && q->y0<=r.y1+1) {
+            ssd1306_ui_union(q, &r);
+            return;
+        }
+
+        ssd1306_ui_rect_t u=*q;
+        ssd1306_ui_union(&u, &r);
+        const uint32_t growth=ssd1306_ui_area(&u)-ssd1306_ui_area(q);
+        if(growth<best_growth) {
+            best_growth=growth;
+            best=i;
+        }
+    }
+
+    if(ui->rect_count<SSD1306_UI_RECTS)
+        ui->rects[ui->rect_count++]=r;
+    else
+        ssd1306_ui_union(&ui->rects[best], &r);
+}
+
+static bool ssd1306_ui_touches(const ssd1306_ui_t *ui, int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+    for(uint32_t i=0; i<ui->rect_count; ++i) {
+        const ssd1306_ui_rect_t *q=&ui->rects[i];
+        if(x0<=q->x1 && q->x0<=x1 && y0<=q->y1 && q->y0<=y1)
+            return true;
+    }
+    return false;
+}
+
+inline static bool ssd1306_ui_is_text(const ssd1306_widget_t *w) {
+    return w->kind==SSD1306_UI_LABEL || w->kind==SSD1306_UI_GRID_ROW || w->kind==SSD1306_UI_FIELD;
+}
+
+// char drawn in cell i of a text widget holding text, '\0' if the cell is empty
+inline static char ssd1306_ui_cell(const ssd1306_widget_t *w, const char *text, size_t len, size_t i) {
+    if(i>=len)
+        return '\0';
+    return w->mask?w->mask:text[i];
+}
+
+static void ssd1306_ui_invalidate_cell(ssd1306_widget_t *w, size_t i) {
+    const int32_t x=w->x+i*w->pitch;
+    ssd1306_ui_invalidate(w->ui, x, w->y, x+w->font[1]*w->scale-1, w->y+w->font[0]*w->scale-1);
+}
+
+inline static int32_t ssd1306_ui_cursor_y(const ssd1306_widget_t *w) {
+    return w->y+w->index*w->pitch;
+}
+
+// records the whole area of w, whether w itself is visible or not, and of its visible widgets
+static void ssd1306_ui_invalidate_widget(ssd1306_widget_t *w) {
+    // one rectangle over all cells, the gaps between them are blank
+    if(ssd1306_ui_is_text(w)) {
+        const size_t len=strlen(w->text);
+        if(len)
+            ssd1306_ui_invalidate(w->ui, w->x, w->y, w->x+(len-1)*w->pitch+w->font[1]*w->scale-1, w->y+w->font[0]*w->scale-1);
+        return;
+    }
+
+    switch(w->kind) {
+    case SSD1306_UI_GROUP:
+        for(ssd1306_widget_t *c=w->child; c; c=c->next)
+            if(c->visible)
+                ssd1306_ui_invalidate_widget(c);
+        break;
+    case SSD1306_UI_CURSOR:
+        ssd1306_ui_invalidate(w->ui, w->x, ssd1306_ui_cursor_y(w), w->x+3, ssd1306_ui_cursor_y(w)+4);
+        break;
+    case SSD1306_UI_ASSET:
+        if(w->asset && w->asset_size>=SSD1306_ASSET_HEADER_SIZE)
+            ssd1306_ui_invalidate(w->ui, w->x, w->y, w->x+w->asset[1]-1, w->y+w->asset[2]-1);
+        break;
+    default:
+        break;
+    }
+}
+
+static void ssd1306_ui_draw(ssd1306_ui_t *ui, const ssd1306_widget_t *w) {
+    ssd1306_t *p=ui->disp;
+
+    if(ssd1306_ui_is_text(w)) {
+        const uint32_t cw=w->font[1]*w->scale, ch=w->font[0]*w->scale;
+        for(size_t i=0, len=strlen(w->text); i<len; ++i) {
+            const int32_t x=w->x+i*w->pitch;
+            if(ssd1306_ui_touches(ui, x, w->y, x+cw-1, w->y+ch-1)) {
+                ssd1306_draw_char_with_font(p, x, w->y, w->scale, w->font, ssd1306_ui_cell(w, w->text, len, i));
+                ++ui->widgets_drawn;
+            }
+        }
+        return;
+    }
+
+    switch(w->kind) {
+    case SSD1306_UI_GROUP:
+        for(const ssd1306_widget_t *c=w->child; c; c=c->next)
+            if(c->visible)
+                ssd1306_ui_draw(ui, c);
+        break;
+    case SSD1306_UI_CURSOR: {
+        const int32_t y=ssd1306_ui_cursor_y(w);
+        if(ssd1306_ui_touches(ui, w->x, y, w->x+3, y+4)) {
+            ssd1306_draw_square(p, w->x, y, 2, 5);
+            ssd1306_draw_square(p, w->x+2, y+1, 1, 3);
+            ssd1306_draw_pixel(p, w->x+3, y+2);
+            ++ui->widgets_drawn;
+        }
+        break;
+    }
+    case SSD1306_UI_ASSET:
+        if(w->asset && w->asset_size>=SSD1306_ASSET_HEADER_SIZE
+                && ssd1306_ui_touches(ui, w->x, w->y, w->x+w->asset[1]-1, w->y+w->asset[2]-1)) {
+            ssd1306_draw_asset(p, w->x, w->y, w->asset, w->asset_size);
+            ++ui->widgets_drawn;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void ssd1306_ui_init(ssd1306_ui_t *ui, ssd1306_t *p) {
+    ui->disp=p;
+    ui->rect_count=0;
+    ui->renders=0;
+    ui->widgets_drawn=0;
+
+    memset(&ui->root, 0, sizeof(ui->root));
+    ui->root.kind=SSD1306_UI_GROUP;
+    ui->root.ui=ui;
+    ui->root.visible=true;
+
+    ssd1306_ui_invalidate(ui, 0, 0, p->width-1, p->height-1);
+}
+
+static void ssd1306_ui_setup(ssd1306_ui_t *ui, ssd1306_widget_t *w, ssd1306_ui_kind_t kind, uint8_t x, uint8_t y) {
+    memset(w, 0, sizeof(*w));
+    w->kind=kind;
+    w->ui=ui;
+    w->x=x;
+    w->y=y;
+    w->visible=true;
+}
+
+// appends w to the group, so it is drawn after the widgets added before
+static void ssd1306_ui_attach(ssd1306_widget_t *w, ssd1306_widget_t *parent) {
+    ssd1306_widget_t **link=&(parent?parent:&w->ui->root)->child;
+
+    w->parent=parent?parent:&w->ui->root;
+    while(*link)
+        link=&(*link)->next;
+    *link=w;
+
+    if(ssd1306_ui_shown(w))
+        ssd1306_ui_invalidate_widget(w);
+}
+
+inline static void ssd1306_ui_copy_text(char *dst, const char *src) {
+    strncpy(dst, src, SSD1306_UI_TEXT);
+    dst[SSD1306_UI_TEXT]='\0';
+}
+
+void ssd1306_ui_add_group(ssd1306_ui_t *ui, ssd1306_widget_t *w, ssd1306_widget_t *parent) {
+    ssd1306_ui_setup(ui, w, SSD1306_UI_GROUP, 0, 0);
+    ssd1306_ui_attach(w, parent);
+}
+
+void ssd1306_ui_add_label(ssd1306_ui_t *ui, ssd1306_widget_t *w, ssd1306_widget_t *parent, uint8_t x, uint8_t y, const uint8_t *font, uint8_t scale, const char *text) {
+    ssd1306_ui_setup(ui, w, SSD1306_UI_LABEL, x, y);
+    w->font=font;
+    w->scale=scale;
+    w->pitch=(font[1]+font[2])*scale;
+    ssd1306_ui_copy_text(w->text, text);
+    ssd1306_ui_attach(w, parent);
+}
+
+void ssd1306_ui_add_grid_row(ssd1306_ui_t *ui, ssd1306_widget_t *w, ssd1306_widget_t *parent, uint8_t x, uint8_t y, const uint8_t *font, uint8_t scale, uint8_t pitch, const char *cells) {
+    ssd1306_ui_setup(ui, w, SSD1306_UI_GRID_ROW, x, y);
+    w->font=font;
+    w->scale=scale;
+    w->pitch=pitch;
+    ssd1306_ui_copy_text(w->text, cells);
+    ssd1306_ui_attach(w, parent);
+}
+
+void ssd1306_ui_add_field(ssd1306_ui_t *ui, ssd1306_widget_t *w, ssd1306_widget_t *parent, uint8_t x, uint8_t y, const uint8_t *font, uint8_t scale, char mask) {
+    ssd1306_ui_setup(ui, w, SSD1306_UI_FIELD, x, y);
+    w->font=font;
+    w->scale=scale;
+    w->pitch=(font[1]+font[2])*scale;
+    w->mask=mask;
+    ssd1306_ui_attach(w, parent);
+}
+
+void ssd1306_ui_add_cursor(ssd1306_ui_t *ui, ssd1306_widget_t *w, ssd1306_widget_t *parent, uint8_t x, uint8_t y, uint8_t pitch) {
+    ssd1306_ui_setup(ui, w, SSD1306_UI_CURSOR, x, y);
+    w->pitch=pitch;
+    ssd1306_ui_attach(w, parent);
+}
+
+void ssd1306_ui_add_asset(ssd1306_ui_t *ui, ssd1306_widget_t *w, ssd1306_widget_t *parent, uint8_t x, uint8_t y, const uint8_t *data, size_t size) {
+    ssd1306_ui_setup(ui, w, SSD1306_UI_ASSET, x, y);
+    w->asset=data;
+    w->asset_size=size;
+    ssd1306_ui_attach(w, parent);
+}
+
+void ssd1306_ui_set_visible(ssd1306_widget_t *w, bool visible) {
+    if(w->visible==visible)
+        return;
+
+    // the area is recorded while shown: before hiding, after showing
+    if(!visible && ssd1306_ui_shown(w))
+        ssd1306_ui_invalidate_widget(w);
+    w->visible=visible;
+    if(visible && ssd1306_ui_shown(w))
+        ssd1306_ui_invalidate_widget(w);
+}
+
+void ssd1306_ui_set_text(ssd1306_widget_t *w, const char *text) {
+    char next[SSD1306_UI_TEXT+1];
+    ssd1306_ui_copy_text(next, text);
+
+    if(ssd1306_ui_shown(w)) {
+        const size_t a=strlen(w->text), b=strlen(next);
+        for(size_t i=0; i<a || i<b; ++i)
+            if(ssd1306_ui_cell(w, w->text, a, i)!=ssd1306_ui_cell(w, next, b, i))
+                ssd1306_ui_invalidate_cell(w, i);
+    }
+
+    memcpy(w->text, next, sizeof(next));
+}
+
+void ssd1306_ui_set_index(ssd1306_widget_t *w, uint8_t index) {
+    if(w->index==index)
+        return;
+
+    const bool shown=ssd1306_ui_shown(w);
+    if(shown)
+        ssd1306_ui_invalidate_widget(w);
+    w->index=index;
+    if(shown)
+        ssd1306_ui_invalidate_widget(w);
+}
+
+void ssd1306_ui_set_asset(ssd1306_widget_t *w, const uint8_t *data, size_t size) {
+    if(w->asset==data && w->asset_size==size)
+        return;
+
+    const bool shown=ssd1306_ui_shown(w);
+    if(shown)
+        ssd1306_ui_invalidate_widget(w);
+    w->asset=data;
+    w->asset_size=size;
+    if(shown)
+        ssd1306_ui_invalidate_widget(w);
+}
+
+bool ssd1306_ui_render(ssd1306_ui_t *ui) {
+    ssd1306_t *p=ui->disp;
+    if(!ui->rect_count)
+        return false;
+
+    const ssd1306_rop_t rop=p->rop;
+    p->rop=SSD1306_ROP_SET;
+
+    for(uint32_t i=0; i<ui->rect_count; ++i) {
+        const ssd1306_ui_rect_t *r=&ui->rects[i];
+        ssd1306_clear_square(p, r->x0, r->y0, r->x1-r->x0+1, r->y1-r->y0+1);
+    }
+    if(ui->root.visible)
+        ssd1306_ui_draw(ui, &ui->root);
+
+    p->rop=rop;
+    ui->rect_count=0;
+    ++ui->renders;
+    return true;
+}
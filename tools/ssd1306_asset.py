@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""
+Converts a monochrome image into a compressed ssd1306 asset (see ssd1306_draw_asset in
+include/ssd1306.h) and prints it as a C array.
+
+Accepted inputs: 1 bit BMP (pixels with the black palette entry are lit, as in
+ssd1306_bmp_show_image) and PBM P1/P4 (1 is lit).
+
+usage: ssd1306_asset.py image.bmp name [-o output.h]
+"""
+
+import argparse
+import struct
+import sys
+
+ASSET_MAGIC = 0xA5
+MAX_BLOCK = 128
+
+
+def read_bmp(data):
+    offset, = struct.unpack_from('<I', data, 10)
+    header_size, width, height = struct.unpack_from('<Iii', data, 14)
+    bit_count, compression = struct.unpack_from('<HI', data, 28)
+    if bit_count != 1 or compression != 0:
+        raise ValueError('only uncompressed 1 bit BMP is supported')
+
+    table = 14 + header_size
+    lit = 0
+    for i in range(2):
+        b, g, r = data[table + i * 4:table + i * 4 + 3]
+        if not (r or g or b):
+            lit = i
+            break
+
+    rows = abs(height)
+    stride = ((width + 31) // 32) * 4
+    pixels = []
+    for y in range(rows):
+        row = y if height < 0 else rows - 1 - y
+        line = data[offset + row * stride:offset + (row + 1) * stride]
+        pixels.append([((line[x >> 3] >> (7 - (x & 7))) & 1) == lit for x in range(width)])
+    return width, rows, pixels
+
+
+def read_pbm(data):
+    tokens = []
+    pos = 0
+    # header: magic, width, height, comments start with '#'
+    while len(tokens) < 3:
+        while data[pos:pos + 1].isspace():
+            pos += 1
+        if data[pos:pos + 1] == b'#':
+            pos = data.index(b'\n', pos)
+            continue
+        start = pos
+        while not data[pos:pos + 1].isspace():
+            pos += 1
+        tokens.append(data[start:pos])
+    magic, width, height = tokens[0], int(tokens[1]), int(tokens[2])
+    pos += 1
+
+    if magic == b'P4':
+        stride = (width + 7) // 8
+        pixels = [[((data[pos + y * stride + (x >> 3)] >> (7 - (x & 7))) & 1) == 1 for x in range(width)]
+                  for y in range(height)]
+    elif magic == b'P1':
+        bits = [c == ord('1') for c in data[pos:] if c in b'01']
+        pixels = [bits[y * width:(y + 1) * width] for y in range(height)]
+    else:
+        raise ValueError('only P1 and P4 PBM are supported')
+    return width, height, pixels
+
+
+def to_pages(width, height, pixels):
+    out = []
+    for page in range((height + 7) // 8):
+        for x in range(width):
+            b = 0
+            for k in range(8):
+                y = page * 8 + k
+                if y < height and pixels[y][x]:
+                    b |= 1 << k
+            out.append(b)
+    return out
+
+
+def pack(raw):
+    out = []
+    literal = []
+
+    def flush_literal():
+        while literal:
+            block = literal[:MAX_BLOCK]
+            del literal[:MAX_BLOCK]
+            out.append(len(block) - 1)
+            out.extend(block)
+
+    i = 0
+    while i < len(raw):
+        run = 1
+        while i + run < len(raw) and raw[i + run] == raw[i] and run < MAX_BLOCK:
+            run += 1
+        # a run block costs two bytes, shorter repeats stay literal
+        if run >= 3:
+            flush_literal()
+            out.extend((0x80 | (run - 1), raw[i]))
+            i += run
+        else:
+            literal.append(raw[i])
+            i += 1
+    flush_literal()
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description='convert a monochrome image into an ssd1306 asset')
+    parser.add_argument('image')
+    parser.add_argument('name', help='name of the C array')
+    parser.add_argument('-o', '--output', help='output file (default: stdout)')
+    args = parser.parse_args()
+
+    with open(args.image, 'rb') as f:
+        data = f.read()
+
+    width, height, pixels = read_bmp(data) if data[:2] == b'BM' else read_pbm(data)
+    if not 0 < width < 256 or not 0 < height < 256:
+        raise ValueError('width and height must be 1..255')
+
+    asset = [ASSET_MAGIC, width, height] + pack(to_pages(width, height, pixels))
+
+    lines = ['// %s: %dx%d, %d bytes (%d raw)' % (args.image, width, height, len(asset), width * ((height + 7) // 8)),
+             'static const uint8_t %s[] = {' % args.name]
+    for i in range(0, len(asset), 16):
+        lines.append('    ' + ', '.join('0x%02X' % b for b in asset[i:i + 16]) + ',')
+    lines.append('};')
+
+    out = open(args.output, 'w') if args.output else sys.stdout
+    out.write('\n'.join(lines) + '\n')
+
+
+if __name__ == '__main__':
+    main()
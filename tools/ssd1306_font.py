@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+"""
+Converts a font into the format of the driver (see ssd1306_draw_char_with_font in
+include/ssd1306.h) and prints it as a C array, keeping only the glyph range that is used.
+
+Font format: height, width, spacing, first char, last char, then for every glyph from first
+to last its columns left to right, each column ceil(height/8) bytes with the top row in bit 0.
+
+Accepted sources: BDF (TTF/OTF fonts can be converted with otf2bdf) and C headers holding an
+array in the driver format, such as include/font.h.
+
+usage: ssd1306_font.py font.bdf name [--chars "0123456789*"] [-o output.h]
+"""
+
+import argparse
+import re
+import sys
+
+
+class Font:
+    def __init__(self, height, width, spacing, glyphs):
+        self.height = height
+        self.width = width
+        self.spacing = spacing
+        self.glyphs = glyphs  # char code -> columns, each an int with the top row in bit 0
+
+    def strip(self, chars):
+        """keeps the smallest range of glyphs that covers chars"""
+        codes = sorted(set(ord(c) for c in chars) & set(self.glyphs))
+        if not codes:
+            raise ValueError('none of the chars is in the font')
+        return Font(self.height, self.width, self.spacing,
+                    {c: self.glyphs[c] for c in range(codes[0], codes[-1] + 1) if c in self.glyphs})
+
+    def to_bytes(self):
+        first, last = min(self.glyphs), max(self.glyphs)
+        parts = (self.height + 7) // 8
+        out = [self.height, self.width, self.spacing, first, last]
+        for c in range(first, last + 1):
+            for col in self.glyphs.get(c, [0] * self.width):
+                out.extend((col >> (8 * k)) & 0xFF for k in range(parts))
+        return out
+
+    def render(self, text, scale=1):
+        """pixels of text as drawn by ssd1306_draw_string_with_font, without the trailing spacing"""
+        advance = (self.width + self.spacing) * scale
+        width = max(len(text) * advance - self.spacing * scale, 1)
+        height = self.height * scale
+        pixels = [[False] * width for _ in range(height)]
+        for i, c in enumerate(text):
+            # chars outside the font are skipped, as by the driver
+            for x, col in enumerate(self.glyphs.get(ord(c), [])):
+                for y in range(self.height):
+                    if (col >> y) & 1:
+                        for dy in range(scale):
+                            for dx in range(scale):
+                                pixels[y * scale + dy][i * advance + x * scale + dx] = True
+        return width, height, pixels
+
+
+def read_c(text):
+    body = text[text.index('{', text.index('[]')) + 1:]
+    values = [int(v, 0) for v in re.findall(r'0[xX][0-9a-fA-F]+|\d+', body[:body.index('}')])]
+    height, width, spacing, first, last = values[:5]
+    parts = (height + 7) // 8
+    glyphs = {}
+    for c in range(first, last + 1):
+        pos = 5 + (c - first) * width * parts
+        glyphs[c] = [sum(values[pos + x * parts + k] << (8 * k) for k in range(parts)) for x in range(width)]
+    return Font(height, width, spacing, glyphs)
+
+
+def read_bdf(text, spacing):
+    lines = iter(text.splitlines())
+    box = ascent = None
+    glyphs = {}
+    for line in lines:
+        fields = line.split()
+        if not fields:
+            continue
+        if fields[0] == 'FONTBOUNDINGBOX':
+            box = [int(v) for v in fields[1:5]]
+        elif fields[0] == 'FONT_ASCENT':
+            ascent = int(fields[1])
+        elif fields[0] == 'STARTCHAR':
+            code, bbx, rows = None, None, []
+            for line in lines:
+                fields = line.split()
+                if not fields:
+                    continue
+                if fields[0] == 'ENCODING':
+                    code = int(fields[1])
+                elif fields[0] == 'BBX':
+                    bbx = [int(v) for v in fields[1:5]]
+                elif fields[0] == 'BITMAP':
+                    for line in lines:
+                        if line.strip() == 'ENDCHAR':
+                            break
+                        rows.append(int(line.strip(), 16))
+                    break
+            if code is None or not 0 < code < 256 or box is None:
+                continue
+            width, height = box[0], box[1]
+            top = ascent if ascent is not None else box[1] + box[3]
+            w, h, xoff, yoff = bbx or box
+            stride = (w + 7) // 8 * 8
+            cols = [0] * width
+            for r, bits in enumerate(rows[:h]):
+                y = top - (yoff + h) + r
+                for c in range(w):
+                    x = xoff - box[2] + c
+                    if (bits >> (stride - 1 - c)) & 1 and 0 <= x < width and 0 <= y < height:
+                        cols[x] |= 1 << y
+            glyphs[code] = cols
+    if box is None:
+        raise ValueError('FONTBOUNDINGBOX missing')
+    return Font(box[1], box[0], spacing, glyphs)
+
+
+def load(path, spacing=1):
+    with open(path, 'r') as f:
+        text = f.read()
+    return read_bdf(text, spacing) if text.startswith('STARTFONT') else read_c(text)
+
+
+def c_array(name, data, comment):
+    lines = ['// %s' % comment, 'static const uint8_t %s[] = {' % name]
+    for i in range(0, len(data), 16):
+        lines.append('    ' + ', '.join('0x%02X' % b for b in data[i:i + 16]) + ',')
+    lines.append('};')
+    return '\n'.join(lines) + '\n'
+
+
+def main():
+    parser = argparse.ArgumentParser(description='convert a font into an ssd1306 font array')
+    parser.add_argument('font', help='BDF file or C header with a font array')
+    parser.add_argument('name', help='name of the C array')
+    parser.add_argument('--chars', help='chars that must be kept, the glyphs outside their range are dropped')
+    parser.add_argument('--spacing', type=int, default=1, help='columns between chars of a BDF font (default: 1)')
+    parser.add_argument('-o', '--output', help='output file (default: stdout)')
+    args = parser.parse_args()
+
+    font = load(args.font, args.spacing)
+    if args.chars:
+        font = font.strip(args.chars)
+    if not 0 < font.height < 256 or not 0 < font.width < 256:
+        raise ValueError('font width and height must be 1..255')
+
+    data = font.to_bytes()
+    comment = '%s: %dx%d, chars %d..%d, %d bytes' % (args.font, font.width, font.height, data[3], data[4], len(data))
+    out = open(args.output, 'w') if args.output else sys.stdout
+    out.write(c_array(args.name, data, comment))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""
+Generates a header with the fonts and pre-rendered screens listed in a manifest, so they are
+stored in flash in the layout the driver draws and nothing is rasterized at run time.
+
+Manifest lines (shell quoting, '#' starts a comment):
+
+    font  NAME SOURCE [CHARS]        font array, keeping only the glyph range covering CHARS
+    text  NAME FONT SCALE TEXT       TEXT rendered as an asset, FONT is a font defined above or a source
+    image NAME IMAGE                 BMP or PBM image as an asset
+
+Fonts are drawn with ssd1306_draw_string_with_font, assets with ssd1306_draw_asset. Paths are
+relative to the manifest.
+
+usage: ssd1306_gen.py assets/keypad.assets [-o include/keypad_assets.h]
+"""
+
+import argparse
+import os
+import re
+import shlex
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import ssd1306_asset  # noqa: E402
+import ssd1306_font  # noqa: E402
+
+
+def asset(width, height, pixels):
+    if not 0 < width < 256 or not 0 < height < 256:
+        raise ValueError('width and height must be 1..255')
+    return [ssd1306_asset.ASSET_MAGIC, width, height] + ssd1306_asset.pack(ssd1306_asset.to_pages(width, height, pixels))
+
+
+def generate(manifest):
+    base = os.path.dirname(manifest)
+    fonts = {}
+    parts = []
+
+    with open(manifest) as f:
+        for number, line in enumerate(f, 1):
+            args = shlex.split(line, comments=True)
+            if not args:
+                continue
+            kind, name = args[0], args[1]
+            if kind == 'font' and len(args) in (3, 4):
+                font = ssd1306_font.load(os.path.join(base, args[2]))
+                if len(args) == 4:
+                    font = font.strip(args[3])
+                fonts[name] = font
+                data = font.to_bytes()
+                comment = '%s: %dx%d, chars %d..%d, %d bytes' % (args[2], font.width, font.height, data[3], data[4], len(data))
+            elif kind == 'text' and len(args) == 5:
+                if args[2] not in fonts:
+                    fonts[args[2]] = ssd1306_font.load(os.path.join(base, args[2]))
+                font, text = fonts[args[2]], args[4]
+                missing = [c for c in text if ord(c) not in font.glyphs]
+                if missing:
+                    raise ValueError('%s:%d: %r not in %s' % (manifest, number, ''.join(missing), args[2]))
+                width, height, pixels = font.render(text, int(args[3]))
+                data = asset(width, height, pixels)
+                comment = '"%s" in %s at scale %s: %dx%d, %d bytes' % (text, args[2], args[3], width, height, len(data))
+            elif kind == 'image' and len(args) == 3:
+                with open(os.path.join(base, args[2]), 'rb') as img:
+                    raw = img.read()
+                width, height, pixels = ssd1306_asset.read_bmp(raw) if raw[:2] == b'BM' else ssd1306_asset.read_pbm(raw)
+                data = asset(width, height, pixels)
+                comment = '%s: %dx%d, %d bytes' % (args[2], width, height, len(data))
+            else:
+                raise ValueError('%s:%d: unknown entry' % (manifest, number))
+            parts.append(ssd1306_font.c_array(name, data, comment))
+
+    guard = '_inc_' + re.sub(r'\W', '_', os.path.splitext(os.path.basename(manifest))[0]) + '_assets'
+    return ('// generated by tools/ssd1306_gen.py from %s, do not edit\n\n#ifndef %s\n#define %s\n#include <stdint.h>\n\n'
+            % (os.path.basename(manifest), guard, guard) + '\n'.join(parts) + '\n#endif\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='generate the fonts and assets of a manifest')
+    parser.add_argument('manifest')
+    parser.add_argument('-o', '--output', help='output file (default: stdout)')
+    args = parser.parse_args()
+
+    header = generate(args.manifest)
+    out = open(args.output, 'w') if args.output else sys.stdout
+    out.write(header)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+"""
+Rebuilds the frames printed by the display mirror (see include/ssd1306_mirror.h) and writes
+them as PBM images.
+
+Reads the board's stdio from a file, a serial device or stdin. Lines that are not mirror
+frames are passed through to stdout. A line that is damaged or follows a lost one is skipped
+until the next K frame.
+
+usage: ssd1306_mirror.py [/dev/ttyACM0 | log.txt | -] [-o frames/] [--ascii]
+"""
+
+import argparse
+import os
+import sys
+
+
+def unpack(data, size):
+    out = bytearray(size)
+    i = pos = 0
+    while i < len(data):
+        n = data[i]
+        if n < 0x80:
+            block = data[i + 1:i + 2 + n]
+            if len(block) != n + 1:
+                raise ValueError('truncated literal block')
+            i += n + 2
+        else:
+            if i + 1 >= len(data):
+                raise ValueError('truncated repeat block')
+            block = bytes((data[i + 1],)) * (n - 0x7F)
+            i += 2
+        if pos + len(block) > size:
+            raise ValueError('frame too long')
+        out[pos:pos + len(block)] = block
+        pos += len(block)
+    return out
+
+
+def to_pixels(width, height, frame):
+    return [[(frame[(y >> 3) * width + x] >> (y & 7)) & 1 for x in range(width)] for y in range(height)]
+
+
+def write_pbm(path, width, height, frame):
+    stride = (width + 7) // 8
+    rows = bytearray()
+    for row in to_pixels(width, height, frame):
+        line = bytearray(stride)
+        for x, lit in enumerate(row):
+            if lit:
+                line[x >> 3] |= 0x80 >> (x & 7)
+        rows += line
+    with open(path, 'wb') as f:
+        f.write(b'P4\n%d %d\n' % (width, height) + bytes(rows))
+
+
+def print_ascii(width, height, frame):
+    for row in to_pixels(width, height, frame):
+        print(''.join('#' if lit else '.' for lit in row))
+    print()
+
+
+class Mirror:
+    def __init__(self):
+        self.frame = None
+        self.seq = None
+        self.size = None
+
+    def feed(self, line):
+        """applies one line, returns (width, height, frame) or None if it was skipped"""
+        fields = line.split()
+        if len(fields) not in (4, 5) or fields[1] not in ('K', 'D'):
+            raise ValueError('malformed line')
+        kind, seq = fields[1], int(fields[2])
+        width, height = (int(v) for v in fields[3].split('x'))
+        data = bytes.fromhex(fields[4]) if len(fields) == 5 else b''
+
+        size = width * ((height + 7) // 8)
+        if kind == 'D' and (self.frame is None or self.size != (width, height) or seq != (self.seq + 1) & 0xFF):
+            self.frame = None
+            return None
+
+        diff = unpack(data, size)
+        base = bytearray(size) if kind == 'K' else self.frame
+        self.frame = bytearray(a ^ b for a, b in zip(base, diff))
+        self.seq = seq
+        self.size = (width, height)
+        return width, height, self.frame
+
+
+def main():
+    parser = argparse.ArgumentParser(description='rebuild the frames of the ssd1306 display mirror')
+    parser.add_argument('input', nargs='?', default='-', help='serial device or log file (default: stdin)')
+    parser.add_argument('-o', '--output', default='.', help='directory of the PBM frames (default: .)')
+    parser.add_argument('--ascii', action='store_true', help='also print the frames as text')
+    args = parser.parse_args()
+
+    os.makedirs(args.output, exist_ok=True)
+    source = sys.stdin if args.input == '-' else open(args.input, 'r', errors='replace')
+    mirror = Mirror()
+    count = 0
+
+    for line in source:
+        start = line.find('@OLED ')
+        if start < 0:
+            sys.stdout.write(line)
+            continue
+
+        try:
+            shown = mirror.feed(line[start:])
+        except ValueError:
+            mirror.frame = None
+            continue
+        if shown is None:
+            continue
+
+        width, height, frame = shown
+        write_pbm(os.path.join(args.output, 'frame_%05d.pbm' % count), width, height, frame)
+        if args.ascii:
+            print_ascii(width, height, frame)
+        count += 1
+
+
+if __name__ == '__main__':
+    main()